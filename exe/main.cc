@@ -6,6 +6,7 @@
 
 #include "motis/config.h"
 #include "motis/data.h"
+#include "motis/footpath_shards.h"
 #include "motis/import.h"
 
 #if !defined(MOTIS_VERSION)
@@ -63,6 +64,8 @@ int main(int ac, char** av) {
       return server(ac, av);
     } else if (cmd == "import") {
       return import(ac, av);
+    } else if (cmd == "footpaths") {
+      return footpaths(ac, av);
     } else {
       try {
         auto const bars = utl::global_progress_bars{false};
@@ -1,6 +1,7 @@
 #include "boost/asio/co_spawn.hpp"
 #include "boost/asio/detached.hpp"
 #include "boost/asio/io_context.hpp"
+#include "boost/json/parse.hpp"
 #include "boost/program_options.hpp"
 
 #include "net/run.h"
@@ -10,8 +11,10 @@
 
 #include "utl/init_from.h"
 
+#include "motis/compression.h"
 #include "motis/config.h"
 #include "motis/cron.h"
+#include "motis/data.h"
 #include "motis/endpoints/adr/geocode.h"
 #include "motis/endpoints/adr/reverse_geocode.h"
 #include "motis/endpoints/elevators.h"
@@ -22,10 +25,14 @@
 #include "motis/endpoints/osr_routing.h"
 #include "motis/endpoints/platforms.h"
 #include "motis/endpoints/routing.h"
+#include "motis/endpoints/static_files.h"
 #include "motis/endpoints/stop_times.h"
 #include "motis/endpoints/tiles.h"
 #include "motis/endpoints/trip.h"
 #include "motis/endpoints/update_elevator.h"
+#include "motis/endpoints/watch.h"
+#include "motis/json_writer.h"
+#include "motis/msgpack.h"
 #include "motis/rt_update.h"
 
 namespace fs = std::filesystem;
@@ -41,6 +48,45 @@ void GET(auto&& r, std::string target, From& from) {
   }
 }
 
+bool accepts_msgpack(net::route_request const& req) {
+  return std::string_view{req[boost::beast::http::field::accept]}.find(
+             "application/x-msgpack") != std::string_view::npos;
+}
+
+// Like GET but answers with MessagePack instead of JSON if requested
+// via `Accept: application/x-msgpack` and gzip compresses large bodies.
+template <typename T, typename From>
+void GET_NEGOTIATED(auto&& r, std::string target, From& from) {
+  if (auto x = utl::init_from<T>(from); x.has_value()) {
+    r.route("GET", std::move(target),
+            [ep = std::move(*x)](net::route_request const& req,
+                                 bool) -> net::reply {
+              auto res = net::web_server::string_res_t{
+                  boost::beast::http::status::ok, req.version()};
+              if (accepts_msgpack(req)) {
+                res.insert(boost::beast::http::field::content_type,
+                           "application/x-msgpack");
+                res.body() = to_msgpack(ep(req.url_));
+              } else {
+                res.insert(boost::beast::http::field::content_type,
+                           "application/json");
+                res.body() = to_json_string(ep(req.url_));
+              }
+              if (res.body().size() >= kMinCompressSize) {
+                res.insert(boost::beast::http::field::vary, "Accept-Encoding");
+                if (accepts_gzip(std::string_view{
+                        req[boost::beast::http::field::accept_encoding]})) {
+                  res.insert(boost::beast::http::field::content_encoding,
+                             "gzip");
+                  res.body() = gzip(res.body());
+                }
+              }
+              res.keep_alive(req.keep_alive());
+              return res;
+            });
+  }
+}
+
 template <typename T, typename From>
 void POST(auto&& r, std::string target, From& from) {
   if (auto const x = utl::init_from<T>(from); x.has_value()) {
@@ -48,25 +94,45 @@ void POST(auto&& r, std::string target, From& from) {
   }
 }
 
+// Like POST but for endpoints that write their JSON response directly.
+template <typename T, typename From>
+void POST_WRITER(auto&& r, std::string target, From& from) {
+  if (auto x = utl::init_from<T>(from); x.has_value()) {
+    r.route("POST", std::move(target),
+            [ep = std::move(*x)](net::route_request const& req,
+                                 bool) -> net::reply {
+              auto res = net::web_server::string_res_t{
+                  boost::beast::http::status::ok, req.version()};
+              res.insert(boost::beast::http::field::content_type,
+                         "application/json");
+              ep.write_json(boost::json::parse(req.body()), res.body());
+              res.keep_alive(req.keep_alive());
+              return res;
+            });
+  }
+}
+
 int server(data d, config const& c) {
   auto ioc = asio::io_context{};
   auto workers = asio::io_context{};
   auto s = net::web_server{ioc};
   auto qr = net::query_router{net::asio_exec({ioc, workers})};
 
-  POST<ep::matches>(qr, "/api/matches", d);
+  POST_WRITER<ep::matches>(qr, "/api/matches", d);
   POST<ep::elevators>(qr, "/api/elevators", d);
   POST<ep::osr_routing>(qr, "/api/route", d);
   POST<ep::platforms>(qr, "/api/platforms", d);
   POST<ep::graph>(qr, "/api/graph", d);
   POST<ep::update_elevator>(qr, "/api/update_elevator", d);
+  POST<ep::watch>(qr, "/api/watch", d);
   GET<ep::footpaths>(qr, "/api/debug/footpaths", d);
   GET<ep::levels>(qr, "/api/v1/levels", d);
   GET<ep::reverse_geocode>(qr, "/api/v1/reverse-geocode", d);
   GET<ep::geocode>(qr, "/api/v1/geocode", d);
-  GET<ep::routing>(qr, "/api/v1/plan", d);
-  GET<ep::stop_times>(qr, "/api/v1/stoptimes", d);
-  GET<ep::trip>(qr, "/api/v1/trip", d);
+  GET_NEGOTIATED<ep::routing>(qr, "/api/v1/plan", d);
+  GET_NEGOTIATED<ep::stop_times>(qr, "/api/v1/stoptimes", d);
+  GET_NEGOTIATED<ep::trip>(qr, "/api/v1/trip", d);
+  GET<ep::trips>(qr, "/api/v1/trips", d);
 
   if (c.tiles_) {
     utl::verify(d.tiles_ != nullptr, "tiles data not loaded");
@@ -74,6 +140,8 @@ int server(data d, config const& c) {
   }
 
   auto const server_config = c.server_.value_or(config::server{});
+  qr.route("GET", ep::static_files::kRoute,
+           ep::static_files{server_config.web_folder_, d.path_ / "web_gzip"});
   qr.serve_files(server_config.web_folder_);
   qr.enable_cors();
   s.on_http_request(std::move(qr));
@@ -84,8 +152,9 @@ int server(data d, config const& c) {
 
   if (c.requires_rt_timetable_updates()) {
     cron(ioc, std::chrono::seconds{c.timetable_->update_interval_}, [&]() {
-      boost::asio::co_spawn(workers, rt_update(c, *d.tt_, *d.tags_, d.rt_),
-                            boost::asio::detached);
+      boost::asio::co_spawn(
+          workers, rt_update(c, *d.tt_, *d.tags_, d.rt_, *d.watch_),
+          boost::asio::detached);
     });
   }
 
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#include "rfl.hpp"
+
+namespace motis {
+
+template <typename T>
+constexpr auto const is_optional_v = false;
+
+template <typename T>
+constexpr auto const is_optional_v<std::optional<T>> = true;
+
+template <typename T>
+bool is_null(T const& x) {
+  if constexpr (is_optional_v<T>) {
+    return !x.has_value();
+  } else {
+    return false;
+  }
+}
+
+// Calls `fn(name, value)` for every set member of an API type generated
+// from openapi.yaml. `name` is the JSON key (member name without trailing
+// underscore). Unset optional members are skipped like in JSON.
+template <typename T, typename Fn>
+void for_each_api_field(T const& x, Fn&& fn) {
+  rfl::to_view(x).apply([&](auto const& f) {
+    if (is_null(*f.value())) {
+      return;
+    }
+    auto const name = std::string_view{f.name()};
+    fn(name.ends_with('_') ? name.substr(0U, name.size() - 1U) : name,
+       *f.value());
+  });
+}
+
+template <typename T>
+std::size_t count_api_fields(T const& x) {
+  auto n = std::size_t{0U};
+  for_each_api_field(x, [&](auto&&, auto&&) { ++n; });
+  return n;
+}
+
+}  // namespace motis
\ No newline at end of file
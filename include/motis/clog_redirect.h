@@ -5,6 +5,8 @@
 
 namespace motis {
 
+// Redirects std::clog output of the calling thread to a file.
+// Import tasks run in parallel, so every thread has its own sink.
 struct clog_redirect {
   explicit clog_redirect(char const* log_file_path);
 
@@ -19,7 +21,8 @@ struct clog_redirect {
 
 private:
   std::ofstream sink_;
-  std::streambuf* backup_clog_;
+  std::streambuf* prev_sink_{nullptr};
+  bool active_{false};
 
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
   static bool enabled_;
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace motis {
+
+// bodies smaller than this are sent uncompressed [bytes]
+constexpr auto const kMinCompressSize = 1024U;
+
+// Whether an `Accept-Encoding` header value allows gzip. Codings are
+// compared case-insensitively, an explicit `gzip` entry overrides `*` and
+// `q=0` marks a coding as not acceptable.
+bool accepts_gzip(std::string_view accept_encoding);
+
+std::string gzip(std::string_view);
+
+}  // namespace motis
\ No newline at end of file
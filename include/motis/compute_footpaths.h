@@ -1,10 +1,21 @@
 #pragma once
 
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include "cista/hash.h"
 #include "cista/memory_holder.h"
 
+#include "utl/progress_tracker.h"
+
+#include "nigiri/footpath.h"
+#include "nigiri/types.h"
+
 #include "osr/types.h"
 
 #include "motis/fwd.h"
+#include "motis/match_platforms.h"
 #include "motis/types.h"
 
 namespace motis {
@@ -13,10 +24,36 @@ using elevator_footpath_map_t = hash_map<
     osr::node_idx_t,
     hash_set<std::pair<nigiri::location_idx_t, nigiri::location_idx_t>>>;
 
+struct footpath_options {
+  bool update_coordinates_{true};
+
+  // Results are checkpointed here (if set) after every range of locations.
+  // A restart with the same key resumes from there.
+  std::filesystem::path checkpoint_{};
+  cista::hash_t checkpoint_key_{0U};
+
+  // Shard worker: only compute footpaths starting at these locations. The
+  // results are only written to the checkpoint, `tt` keeps its footpaths.
+  std::optional<std::vector<nigiri::location_idx_t>> locations_{};
+
+  // Checkpoints written by shard workers. Their results are used as-is.
+  std::vector<std::filesystem::path> shard_results_{};
+
+  // Progress is reported here. Default: the active progress tracker.
+  utl::progress_tracker_ptr pt_{};
+};
+
+using footpaths_t =
+    nigiri::vector_map<nigiri::location_idx_t, std::vector<nigiri::footpath>>;
+
+// `centers`, `matches` and `positions` are the results of the matches
+// import task (see match_platforms.h).
 elevator_footpath_map_t compute_footpaths(osr::ways const&,
                                           osr::lookup const&,
-                                          osr::platforms const&,
                                           nigiri::timetable&,
-                                          bool update_coordinates);
+                                          platform_centers_t const& centers,
+                                          platform_matches_t const& matches,
+                                          location_positions_t const& positions,
+                                          footpath_options const&);
 
 }  // namespace motis
\ No newline at end of file
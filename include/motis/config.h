@@ -39,6 +39,17 @@ struct config {
   };
   std::optional<server> server_{};
 
+  // Each footpath shard worker loads the complete timetable, street data
+  // and matches. Workers running at the same time are limited by n_tasks
+  // and memory_mb (default: physical memory), shards by kMaxFootpathShards.
+  struct import_budget {
+    bool operator==(import_budget const&) const = default;
+    unsigned n_tasks_{4U};
+    std::optional<std::uint64_t> memory_mb_{};
+    std::optional<unsigned> footpath_shards_{};
+  };
+  std::optional<import_budget> import_budget_{};
+
   std::optional<std::filesystem::path> osm_{};
   std::optional<std::filesystem::path> fasta_{};
 
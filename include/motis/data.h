@@ -47,6 +47,7 @@ struct data {
 
   void load_osr();
   void load_tt();
+  void load_shapes();
   void load_geocoder();
   void load_matches();
   void load_reverse_geocoder();
@@ -55,8 +56,9 @@ struct data {
 
   auto cista_members() {
     // !!! Remember to add all new members !!!
-    return std::tie(t_, r_, tc_, w_, pl_, l_, tt_, tags_, location_rtee_,
-                    elevator_nodes_, matches_, rt_);
+    return std::tie(t_, r_, tc_, w_, pl_, l_, tt_, tags_, trip_ids_,
+                    location_rtee_, elevator_nodes_, matches_, positions_,
+                    platform_centers_, route_names_, shapes_, rt_, watch_);
   }
 
   std::filesystem::path path_;
@@ -68,11 +70,17 @@ struct data {
   ptr<osr::lookup> l_;
   cista::wrapped<nigiri::timetable> tt_;
   cista::wrapped<tag_lookup> tags_;
+  ptr<trip_id_index> trip_ids_;
   ptr<point_rtree<nigiri::location_idx_t>> location_rtee_;
   ptr<hash_set<osr::node_idx_t>> elevator_nodes_;
   cista::wrapped<platform_matches_t> matches_;
+  cista::wrapped<location_positions_t> positions_;
+  cista::wrapped<platform_centers_t> platform_centers_;
+  cista::wrapped<location_route_names_t> route_names_;
+  ptr<shapes> shapes_;
   ptr<tiles_data> tiles_;
   std::shared_ptr<rt> rt_{std::make_shared<rt>()};
+  ptr<itinerary_watch> watch_;
 };
 
 }  // namespace motis
\ No newline at end of file
@@ -8,7 +8,6 @@ namespace motis::ep {
 struct geocode {
   api::geocode_response operator()(boost::urls::url_view const& url) const;
 
-  nigiri::timetable const& tt_;
   tag_lookup const& tags_;
   adr::typeahead const& t_;
   adr::cache& cache_;
@@ -9,7 +9,6 @@ struct reverse_geocode {
   api::reverseGeocode_response operator()(
       boost::urls::url_view const& url) const;
 
-  nigiri::timetable const& tt_;
   tag_lookup const& tags_;
   adr::typeahead const& t_;
   adr::reverse const& r_;
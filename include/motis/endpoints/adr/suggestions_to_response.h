@@ -10,7 +10,6 @@ namespace motis {
 
 api::geocode_response suggestions_to_response(
     adr::typeahead const&,
-    nigiri::timetable const&,
     tag_lookup const&,
     std::basic_string<adr::language_idx_t> const& lang_indices,
     std::vector<adr::token> const& token_pos,
@@ -23,6 +23,7 @@ struct footpaths {
   osr::platforms const& pl_;
   point_rtree<nigiri::location_idx_t> const& loc_rtree_;
   platform_matches_t const& matches_;
+  location_positions_t const& positions_;
   std::shared_ptr<rt> rt_;
 };
 
@@ -1,22 +1,31 @@
 #pragma once
 
+#include <string>
+
 #include "boost/json/value.hpp"
 
 #include "nigiri/types.h"
 
 #include "motis/fwd.h"
+#include "motis/match_platforms.h"
 #include "motis/point_rtree.h"
 
 namespace motis::ep {
 
+// Debug view of the platform matching as GeoJSON.
+// Writes at most kMaxFeatures features, at most half of them platforms
+// (then sets "truncated": true).
 struct matches {
-  boost::json::value operator()(boost::json::value const&) const;
+  void write_json(boost::json::value const&, std::string& out) const;
 
   point_rtree<nigiri::location_idx_t> const& loc_rtree_;
   nigiri::timetable const& tt_;
   osr::ways const& w_;
   osr::lookup const& l_;
   osr::platforms const& pl_;
+  platform_matches_t const& matches_;
+  platform_centers_t const& platform_centers_;
+  location_route_names_t const& route_names_;
 };
 
 }  // namespace motis::ep
\ No newline at end of file
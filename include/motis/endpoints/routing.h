@@ -6,6 +6,7 @@
 #include "motis-api/motis-api.h"
 #include "motis/elevators/elevators.h"
 #include "motis/fwd.h"
+#include "motis/match_platforms.h"
 
 namespace motis::ep {
 
@@ -35,6 +36,8 @@ struct routing {
   tag_lookup const& tags_;
   point_rtree<nigiri::location_idx_t> const& loc_tree_;
   vector_map<nigiri::location_idx_t, osr::platform_idx_t> const& matches_;
+  location_positions_t const& positions_;
+  std::unique_ptr<shapes> const& shapes_;
   std::shared_ptr<rt> const& rt_;
 };
 
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <filesystem>
+
+#include "net/web_server/query_router.h"
+
+namespace motis::ep {
+
+// Serves the compressible files of the web UI (see kRoute). Their gzip
+// version is written to `gzip_dir_` on first access and sent to clients
+// accepting it. Both versions are sent as file bodies, i.e. read by the
+// web server without copying them into the response. All other files are
+// left to `query_router::serve_files`.
+struct static_files {
+  static constexpr auto const kRoute =
+      R"((.*/|.*\.(html|js|mjs|css|json|map|svg|wasm|txt)))";
+
+  static_files(std::filesystem::path root, std::filesystem::path gzip_dir);
+
+  net::reply operator()(net::route_request const&, bool) const;
+
+  std::filesystem::path root_;
+  std::filesystem::path gzip_dir_;
+};
+
+}  // namespace motis::ep
\ No newline at end of file
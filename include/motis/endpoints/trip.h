@@ -2,12 +2,22 @@
 
 #include "boost/url/url_view.hpp"
 
+#include "date/date.h"
+
+#include "nigiri/rt/run.h"
+
 #include "motis-api/motis-api.h"
 #include "motis/elevators/elevators.h"
 #include "motis/fwd.h"
 
 namespace motis::ep {
 
+nigiri::rt::run resolve_run(nigiri::timetable const&,
+                            trip_id_index const&,
+                            date::sys_days day,
+                            nigiri::source_idx_t,
+                            std::string_view trip_id);
+
 struct trip {
   api::Itinerary operator()(boost::urls::url_view const&) const;
 
@@ -16,8 +26,25 @@ struct trip {
   osr::platforms const& pl_;
   nigiri::timetable const& tt_;
   tag_lookup const& tags_;
+  trip_id_index const& trip_ids_;
+  point_rtree<nigiri::location_idx_t> const& loc_tree_;
+  vector_map<nigiri::location_idx_t, osr::platform_idx_t> const& matches_;
+  std::unique_ptr<shapes> const& shapes_;
+  std::shared_ptr<rt> const& rt_;
+};
+
+struct trips {
+  api::trips_response operator()(boost::urls::url_view const&) const;
+
+  osr::ways const& w_;
+  osr::lookup const& l_;
+  osr::platforms const& pl_;
+  nigiri::timetable const& tt_;
+  tag_lookup const& tags_;
+  trip_id_index const& trip_ids_;
   point_rtree<nigiri::location_idx_t> const& loc_tree_;
   vector_map<nigiri::location_idx_t, osr::platform_idx_t> const& matches_;
+  std::unique_ptr<shapes> const& shapes_;
   std::shared_ptr<rt> const& rt_;
 };
 
@@ -21,10 +21,9 @@ struct update_elevator {
   nigiri::timetable const& tt_;
   osr::ways const& w_;
   osr::lookup const& l_;
-  osr::platforms const& pl_;
   point_rtree<nigiri::location_idx_t> const& loc_rtree_;
   hash_set<osr::node_idx_t> const& elevator_nodes_;
-  platform_matches_t const& matches_;
+  location_positions_t const& positions_;
   std::shared_ptr<rt>& rt_;
 };
 
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "boost/json/value.hpp"
+
+#include "nigiri/types.h"
+
+#include "motis/fwd.h"
+#include "motis/itinerary_watch.h"
+
+namespace motis::ep {
+
+struct watch {
+  boost::json::value operator()(boost::json::value const&) const;
+
+  nigiri::timetable const& tt_;
+  tag_lookup const& tags_;
+  trip_id_index const& trip_ids_;
+  std::shared_ptr<rt> const& rt_;
+  itinerary_watch& watch_;
+};
+
+}  // namespace motis::ep
\ No newline at end of file
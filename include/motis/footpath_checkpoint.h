@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cinttypes>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "cista/hash.h"
+#include "cista/mmap.h"
+
+#include "nigiri/footpath.h"
+#include "nigiri/types.h"
+
+#include "osr/types.h"
+
+namespace motis {
+
+// Append-only scratch file with the results of finished location ranges of
+// compute_footpaths(), so an interrupted computation can resume. Shard
+// workers use the same format to hand their results to the import.
+//
+// Layout: [key, committed size] followed by one record per range:
+//   [profile, n_locations, n_elevator_paths] [locations]
+//   [number of footpaths per location] [footpaths] [elevator paths]
+// A record counts only once the committed size in the header covers it.
+struct footpath_checkpoint {
+  struct elevator_path {
+    osr::node_idx_t node_;
+    nigiri::location_idx_t from_, to_;
+  };
+
+  struct range {
+    std::uint32_t profile_;
+    std::vector<nigiri::location_idx_t> locations_;
+    std::vector<std::vector<nigiri::footpath>> footpaths_;
+    std::vector<elevator_path> elevator_paths_;
+  };
+
+  // Starts from scratch if the file was written for a different `key`.
+  footpath_checkpoint(std::filesystem::path const&, cista::hash_t key);
+
+  std::vector<range> read() const;
+
+  // Reads the file without changing it. Empty if it does not exist or was
+  // written for a different `key`.
+  static std::vector<range> read(std::filesystem::path const&,
+                                 cista::hash_t key);
+
+  void add(std::uint32_t profile,
+           std::span<nigiri::location_idx_t const> locations,
+           nigiri::vector_map<nigiri::location_idx_t,
+                              std::vector<nigiri::footpath>> const& footpaths,
+           std::span<elevator_path const> elevator_paths);
+
+  cista::mmap mmap_;
+};
+
+}  // namespace motis
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "cista/hash.h"
+
+#include "nigiri/types.h"
+
+#include "motis/fwd.h"
+
+namespace motis {
+
+// Every shard worker loads all data, more shards only add loading time.
+constexpr auto const kMaxFootpathShards = 64U;
+
+// Splits the locations into `n` shards of equal size. Each shard is a
+// consecutive part of the Hilbert curve, i.e. a spatially compact area.
+std::vector<std::vector<nigiri::location_idx_t>> get_footpath_shards(
+    nigiri::timetable const&, unsigned n);
+
+std::filesystem::path get_footpath_shard_path(
+    std::filesystem::path const& data_path, unsigned shard, unsigned n);
+
+// Worker: computes the footpaths of one shard with the timetable and
+// street data in `data_path` and writes them to its shard path.
+void compute_footpath_shard(std::filesystem::path const& data_path,
+                            unsigned shard,
+                            unsigned n,
+                            cista::hash_t key);
+
+// Command line of a worker: `footpaths --data .. --shard .. --shards ..`.
+// Executables calling run_footpath_shards() have to dispatch it here.
+int footpaths(int ac, char** av);
+
+// Runs a worker process (this executable with the `footpaths` command) for
+// every shard without complete results, at most `max_workers` (at least one)
+// at a time. Each worker holds the timetable, street data and matches in
+// memory like the importing process.
+// Shards computed elsewhere (e.g. on other machines sharing the data
+// directory) are used as they are.
+// Returns the paths of all shard results.
+std::vector<std::filesystem::path> run_footpath_shards(
+    nigiri::timetable const&,
+    std::filesystem::path const& data_path,
+    unsigned n,
+    cista::hash_t key,
+    unsigned max_workers);
+
+}  // namespace motis
\ No newline at end of file
@@ -25,6 +25,9 @@ struct offset;
 namespace motis {
 struct tiles_data;
 struct rt;
+struct shapes;
+struct itinerary_watch;
 struct tag_lookup;
+struct trip_id_index;
 struct config;
 }  // namespace motis
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <span>
+#include <utility>
+
+#include "geo/latlng.h"
+
+namespace motis {
+
+// Batched geometry kernels. The implementation is picked once at runtime:
+// AVX2 if the CPU supports it, portable scalar code otherwise.
+//
+// Distances use an equirectangular projection around `x`. For the
+// distances these are used for (up to a few kilometers) the difference to
+// geo::distance is far below a meter.
+
+// out[i] = distance [meters] from `x` to points[i], out.size() >= points.size()
+void approx_distances(geo::latlng const& x,
+                      std::span<geo::latlng const> points,
+                      std::span<double> out);
+
+// Closest point on `polyline` to `x` and its distance [meters].
+// `polyline` must not be empty.
+std::pair<geo::latlng, double> closest_on_polyline(
+    geo::latlng const& x, std::span<geo::latlng const> polyline);
+
+// Name of the active implementation ("avx2" or "scalar").
+char const* geo_kernels_impl();
+
+}  // namespace motis
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cinttypes>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cista/hash.h"
+
+namespace motis {
+
+// Content hashes of input files by path. An entry is reused as long as size,
+// modification time and inode of the file did not change.
+struct file_hash_cache {
+  static file_hash_cache read(std::filesystem::path const&);
+  void write(std::filesystem::path const&) const;
+
+  // path -> {size, mtime, inode, hash}
+  std::map<std::string, std::vector<std::uint64_t>> entries_;
+};
+
+// Hash of the full file content (of all files for directories).
+// Inline data (path starting with "\n#") is hashed as is.
+cista::hash_t hash_file(std::filesystem::path const&, file_hash_cache&);
+
+}  // namespace motis
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "nigiri/rt/run.h"
+#include "nigiri/types.h"
+
+#include "motis/fwd.h"
+#include "motis/types.h"
+
+namespace motis {
+
+using watch_id_t = cista::strong<std::uint32_t, struct watch_id_>;
+
+struct itinerary_watch {
+  static constexpr auto const kMaxWatches = std::size_t{100'000U};
+
+  // At most `max_watches` are kept, adding more removes the oldest.
+  explicit itinerary_watch(std::size_t max_watches = kMaxWatches);
+
+  struct leg {
+    nigiri::rt::run r_;
+    nigiri::stop_idx_t enter_, exit_;
+    nigiri::unixtime_t dep_, arr_;
+    nigiri::duration_t dep_delay_{0}, arr_delay_{0};
+    bool is_rt_{false};
+    bool cancelled_{false};
+  };
+
+  struct transfer {
+    std::optional<nigiri::duration_t> min_duration_;  // nullopt: no footpath
+    nigiri::duration_t slack_;
+    bool feasible_;
+  };
+
+  struct itinerary {
+    std::vector<leg> legs_;
+    std::vector<transfer> transfers_;
+    std::uint32_t version_{0U};
+  };
+
+  struct leg_query {
+    nigiri::rt::run r_;
+    nigiri::location_idx_t from_, to_;
+  };
+
+  watch_id_t add(nigiri::timetable const&,
+                 nigiri::rt_timetable const*,
+                 std::vector<leg_query> const&);
+  void remove(watch_id_t);
+
+  std::optional<itinerary> get(watch_id_t) const;
+
+  // Re-checks only watched trips the real-time update touched (i.e. trips
+  // with a real-time copy in `rtt` or that had one before).
+  // Returns the number of itineraries that changed.
+  std::size_t update(nigiri::timetable const&, nigiri::rt_timetable const&);
+
+private:
+  void erase(std::map<watch_id_t, itinerary>::iterator);
+
+  mutable std::mutex mutex_;
+  std::size_t max_watches_;
+  std::uint32_t update_count_{0U};
+  watch_id_t next_id_{0U};
+  std::map<watch_id_t, itinerary> itineraries_;  // ordered by age
+  hash_map<nigiri::transport, std::vector<std::pair<watch_id_t, unsigned>>>
+      transport_legs_;
+};
+
+}  // namespace motis
\ No newline at end of file
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <memory_resource>
 #include <string_view>
+#include <tuple>
+#include <unordered_map>
 #include <variant>
 
+#include "cista/equal_to.h"
+#include "cista/hashing.h"
+
 #include "nigiri/routing/journey.h"
 #include "nigiri/types.h"
 
@@ -23,17 +29,33 @@ inline std::ostream& operator<<(std::ostream& out, place_t const p) {
   return std::visit([&](auto const l) -> std::ostream& { return out << l; }, p);
 }
 
-using street_routing_cache_t = hash_map<std::tuple<osr::location,
-                                                   osr::location,
-                                                   osr::search_profile,
-                                                   std::vector<bool>>,
-                                        std::optional<osr::path>>;
+// Lives as long as the request. Construct it with the request's arena:
+// journey_to_response takes its temporaries from the same memory resource.
+using street_routing_cache_t = std::pmr::unordered_map<
+    std::tuple<osr::location,
+               osr::location,
+               osr::search_profile,
+               std::pmr::vector<bool>>,
+    std::optional<osr::path>,
+    cista::hash_all,
+    cista::equals_all>;
 
 api::Place to_place(nigiri::timetable const&,
                     tag_lookup const&,
                     place_t,
                     std::string_view);
 
+// Stops of a response written once, intermediate stops of legs only
+// reference them by index (`compactPlaces=true`).
+struct place_table {
+  std::int64_t get(nigiri::timetable const&,
+                   tag_lookup const&,
+                   nigiri::location_idx_t);
+
+  hash_map<nigiri::location_idx_t, std::int64_t> idx_;
+  std::vector<api::Place> places_;
+};
+
 api::Itinerary journey_to_response(
     osr::ways const&,
     osr::lookup const&,
@@ -43,10 +65,15 @@ api::Itinerary journey_to_response(
     elevators const* e,
     nigiri::rt_timetable const*,
     vector_map<nigiri::location_idx_t, osr::platform_idx_t> const& matches,
+    shapes const*,
     bool const wheelchair,
+    bool const debug,
+    double geometry_tolerance,
+    unsigned geometry_precision,
     nigiri::routing::journey const&,
     place_t const& start,
     place_t const& dest,
+    place_table*,
     street_routing_cache_t&,
     osr::bitvec<osr::node_idx_t>& blocked_mem);
 
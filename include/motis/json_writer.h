@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cinttypes>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "boost/json/value.hpp"
+#include "boost/json/value_from.hpp"
+
+#include "motis/api_reflection.h"
+
+namespace motis {
+
+// Writes JSON directly into `out_` without building a document first.
+struct json_writer {
+  explicit json_writer(std::string& out) : out_{out} {}
+
+  void begin_object();
+  void end_object();
+  void begin_array();
+  void end_array();
+  void key(std::string_view);
+
+  void null();
+  void value(bool);
+  void value(std::int64_t);
+  void value(std::uint64_t);
+  void value(double);
+  void value(std::string_view);
+  void value(boost::json::value const&);
+
+  // Unset optionals are omitted.
+  template <typename T>
+  void member(std::string_view k, T const& v) {
+    if (is_null(v)) {
+      return;
+    }
+    key(k);
+    write(v);
+  }
+
+  template <typename T>
+  void write(T const& x) {
+    if constexpr (std::is_same_v<T, boost::json::value>) {
+      value(x);
+    } else if constexpr (std::is_same_v<T, bool>) {
+      value(x);
+    } else if constexpr (std::is_enum_v<T>) {
+      value(std::string_view{boost::json::value_from(x).as_string()});
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+      value(static_cast<std::int64_t>(x));
+    } else if constexpr (std::is_integral_v<T>) {
+      value(static_cast<std::uint64_t>(x));
+    } else if constexpr (std::is_floating_point_v<T>) {
+      value(static_cast<double>(x));
+    } else if constexpr (std::is_convertible_v<T const&, std::string_view>) {
+      value(std::string_view{x});
+    } else if constexpr (is_optional_v<T>) {
+      if (x.has_value()) {
+        write(*x);
+      } else {
+        null();
+      }
+    } else if constexpr (requires { typename T::mapped_type; }) {
+      begin_object();
+      for (auto const& [k, v] : x) {
+        member(k, v);
+      }
+      end_object();
+    } else if constexpr (std::ranges::range<T>) {
+      begin_array();
+      for (auto const& e : x) {
+        write(e);
+      }
+      end_array();
+    } else if constexpr (std::is_aggregate_v<T>) {
+      begin_object();
+      for_each_api_field(
+          x, [&](std::string_view k, auto const& v) { member(k, v); });
+      end_object();
+    } else {
+      value(boost::json::value_from(x));
+    }
+  }
+
+  std::string& out_;
+
+private:
+  void separator();
+
+  bool first_{true};
+};
+
+template <typename T>
+std::string to_json_string(T const& x) {
+  auto out = std::string{};
+  json_writer{out}.write(x);
+  return out;
+}
+
+}  // namespace motis
\ No newline at end of file
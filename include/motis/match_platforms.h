@@ -1,9 +1,20 @@
+#pragma once
+
 #include <map>
 #include <optional>
+#include <string_view>
+#include <vector>
+
+#include "cista/hash.h"
+
+#include "geo/latlng.h"
+
+#include "nigiri/types.h"
 
+#include "osr/location.h"
 #include "osr/types.h"
 
-#include "motis/data.h"
+#include "motis/fwd.h"
 #include "motis/types.h"
 
 namespace motis {
@@ -11,18 +22,77 @@ namespace motis {
 using platform_matches_t =
     vector_map<nigiri::location_idx_t, osr::platform_idx_t>;
 
+using location_positions_t = vector_map<nigiri::location_idx_t, osr::location>;
+
+using match_fingerprints_t = vector_map<nigiri::location_idx_t, cista::hash_t>;
+
+using platform_centers_t = vector_map<osr::platform_idx_t, geo::latlng>;
+
+// location -> names of all transports stopping there (", " separated)
+using location_route_names_t = nigiri::vecvec<nigiri::location_idx_t, char>;
+
 std::optional<geo::latlng> get_platform_center(osr::platforms const&,
                                                osr::ways const&,
                                                osr::platform_idx_t);
 
+// Center of every platform, (0, 0) for platforms without geometry.
+platform_centers_t get_platform_centers(osr::platforms const&,
+                                        osr::ways const&);
+
+// Per platform data used to score match candidates, computed once up front
+// instead of once per candidate.
+struct platform_features {
+  platform_features(osr::platforms const&, platform_centers_t const&);
+
+  // Only parses the names of the given (sorted) platforms.
+  platform_features(osr::platforms const&,
+                    platform_centers_t const&,
+                    std::vector<osr::platform_idx_t> const&);
+
+  platform_centers_t const& centers_;
+  nigiri::vecvec<osr::platform_idx_t, unsigned> numbers_;  // of names
+};
+
 osr::platform_idx_t get_match(nigiri::timetable const&,
                               osr::platforms const&,
                               osr::ways const&,
+                              platform_features const&,
                               nigiri::location_idx_t);
 
 platform_matches_t get_matches(nigiri::timetable const&,
                                osr::platforms const&,
-                               osr::ways const&);
+                               osr::ways const&,
+                               platform_centers_t const&);
+
+// Hash of everything get_match() looks at for a location: tagged id, name,
+// coordinate and the names of all routes stopping there. The coordinates
+// have to be the ones from the timetable sources, i.e. not yet moved to the
+// platform centers by compute_footpaths().
+match_fingerprints_t get_match_fingerprints(nigiri::timetable const&,
+                                            tag_lookup const&);
+
+// Like get_matches(), but takes the match of every location whose
+// fingerprint did already exist in the previous import from `prev_matches`.
+// Only valid if the street data (and therefore the platform indices) did
+// not change since `prev_matches` were computed.
+platform_matches_t update_matches(nigiri::timetable const&,
+                                  osr::platforms const&,
+                                  osr::ways const&,
+                                  platform_centers_t const&,
+                                  match_fingerprints_t const& fingerprints,
+                                  match_fingerprints_t const& prev_fingerprints,
+                                  platform_matches_t const& prev_matches);
+
+location_route_names_t get_location_route_names(nigiri::timetable const&);
+
+// Routing start/target of every location: the center of the matched
+// platform (if closer than kMaxAdjust to the timetable coordinate) with the
+// platform level, otherwise the timetable coordinate on level 0.
+location_positions_t get_location_positions(nigiri::timetable const&,
+                                            osr::platforms const&,
+                                            osr::ways const&,
+                                            platform_centers_t const&,
+                                            platform_matches_t const&);
 
 std::optional<std::string_view> get_track(std::string_view);
 
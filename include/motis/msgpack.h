@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cinttypes>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "boost/json/value.hpp"
+#include "boost/json/value_from.hpp"
+
+#include "motis/api_reflection.h"
+
+namespace motis::msgpack {
+
+void write_nil(std::string&);
+void write_bool(std::string&, bool);
+void write_int(std::string&, std::int64_t);
+void write_uint(std::string&, std::uint64_t);
+void write_double(std::string&, double);
+void write_str(std::string&, std::string_view);
+void write_array_header(std::string&, std::size_t);
+void write_map_header(std::string&, std::size_t);
+void write_json(std::string&, boost::json::value const&);
+
+template <typename T>
+void write(std::string&, T const&);
+
+// Writes the API types generated from openapi.yaml as map with the same keys
+// as their JSON representation.
+template <typename T>
+void write_object(std::string& out, T const& x) {
+  write_map_header(out, count_api_fields(x));
+  for_each_api_field(x, [&](std::string_view name, auto const& value) {
+    write_str(out, name);
+    write(out, value);
+  });
+}
+
+template <typename T>
+void write(std::string& out, T const& x) {
+  if constexpr (std::is_same_v<T, boost::json::value>) {
+    write_json(out, x);
+  } else if constexpr (std::is_same_v<T, bool>) {
+    write_bool(out, x);
+  } else if constexpr (std::is_enum_v<T>) {
+    write_str(out, boost::json::value_from(x).as_string());
+  } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+    write_int(out, static_cast<std::int64_t>(x));
+  } else if constexpr (std::is_integral_v<T>) {
+    write_uint(out, static_cast<std::uint64_t>(x));
+  } else if constexpr (std::is_floating_point_v<T>) {
+    write_double(out, static_cast<double>(x));
+  } else if constexpr (std::is_convertible_v<T const&, std::string_view>) {
+    write_str(out, x);
+  } else if constexpr (is_optional_v<T>) {
+    if (x.has_value()) {
+      write(out, *x);
+    } else {
+      write_nil(out);
+    }
+  } else if constexpr (requires { typename T::mapped_type; }) {
+    write_map_header(out, x.size());
+    for (auto const& [key, value] : x) {
+      write(out, key);
+      write(out, value);
+    }
+  } else if constexpr (std::ranges::sized_range<T>) {
+    write_array_header(out, std::ranges::size(x));
+    for (auto const& e : x) {
+      write(out, e);
+    }
+  } else if constexpr (std::is_aggregate_v<T>) {
+    write_object(out, x);
+  } else {
+    write_json(out, boost::json::value_from(x));
+  }
+}
+
+}  // namespace motis::msgpack
+
+namespace motis {
+
+template <typename T>
+std::string to_msgpack(T const& x) {
+  auto out = std::string{};
+  msgpack::write(out, x);
+  return out;
+}
+
+}  // namespace motis
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace motis {
+
+// Calls fn(state, i) for every i in [0, costs.size()) on all cores. Items
+// are started in order of descending cost. Idle threads take the next item
+// from a shared counter, so the expensive items run first and the cheap
+// ones fill up the tail. `state` is one ThreadLocal per thread.
+template <typename ThreadLocal, typename Fn>
+void parallel_for_by_cost_threadlocal(std::vector<std::uint32_t> const& costs,
+                                      Fn&& fn) {
+  auto order = std::vector<std::uint32_t>(costs.size());
+  std::iota(begin(order), end(order), 0U);
+  std::stable_sort(begin(order), end(order),
+                   [&](std::uint32_t const a, std::uint32_t const b) {
+                     return costs[a] > costs[b];
+                   });
+
+  auto next = std::atomic_size_t{0U};
+  auto error_mutex = std::mutex{};
+  auto error = std::exception_ptr{};
+  auto const work = [&]() {
+    auto state = ThreadLocal{};
+    for (auto i = next.fetch_add(1U, std::memory_order_relaxed);
+         i < order.size(); i = next.fetch_add(1U, std::memory_order_relaxed)) {
+      try {
+        fn(state, std::size_t{order[i]});
+      } catch (...) {
+        auto const lock = std::scoped_lock{error_mutex};
+        if (error == nullptr) {
+          error = std::current_exception();
+        }
+        next = order.size();
+      }
+    }
+  };
+
+  {
+    auto const n_threads = std::min(
+        order.size(),
+        std::size_t{std::max(1U, std::thread::hardware_concurrency())});
+    auto threads = std::vector<std::jthread>{};
+    for (auto i = std::size_t{1U}; i < n_threads; ++i) {
+      threads.emplace_back(work);
+    }
+    work();
+  }
+
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+template <typename Fn>
+void parallel_for_by_cost(std::vector<std::uint32_t> const& costs, Fn&& fn) {
+  struct no_state {};
+  parallel_for_by_cost_threadlocal<no_state>(
+      costs, [&](no_state&, std::size_t const i) { fn(i); });
+}
+
+}  // namespace motis
\ No newline at end of file
@@ -1,14 +1,23 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <cinttypes>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
 
+#include "cista/containers/vector.h"
 #include "cista/strong.h"
 
-#include "rtree.h"
-
 #include "geo/box.h"
 #include "geo/latlng.h"
 
+#include "motis/geo_kernels.h"
+
 namespace motis {
 
 template <typename T, typename Fn>
@@ -16,40 +25,122 @@ concept RtreePosHandler = requires(geo::latlng const& pos, T const x, Fn&& f) {
   { std::forward<Fn>(f)(pos, x) };
 };
 
+// Immutable, bulk-loaded packed R-tree over points.
+//
+// Points are sorted along a Hilbert curve and stored contiguously. Every
+// node covers kNodeSize consecutive entries of the level below, so child
+// positions are implicit and a node is nothing but its bounding box.
+// All members are cista containers, i.e. the index can be serialized.
 template <typename T>
 struct point_rtree {
-  point_rtree() : rtree_{rtree_new()} {}
+  static constexpr auto const kNodeSize = 16U;
+  static constexpr auto const kMaxDepth = 8U;  // kNodeSize^8 = 2^32 entries
+
+  // Relative error band of approx_distances() checked with geo::distance.
+  static constexpr auto const kApproxTolerance = 0.05;
+
+  struct entry {
+    geo::latlng pos_;
+    T item_;
+  };
 
-  ~point_rtree() {
-    if (rtree_ != nullptr) {
-      rtree_free(rtree_);
+  struct bbox {
+    bool overlaps(bbox const& o) const {
+      return min_lat_ <= o.max_lat_ && o.min_lat_ <= max_lat_ &&
+             min_lng_ <= o.max_lng_ && o.min_lng_ <= max_lng_;
     }
-  }
 
-  point_rtree(point_rtree const&) = delete;
-  point_rtree(point_rtree&& o) {
-    if (this != &o) {
-      rtree_ = o.rtree_;
-      o.rtree_ = nullptr;
+    bool contains(geo::latlng const& p) const {
+      return min_lat_ <= p.lat_ && p.lat_ <= max_lat_ && min_lng_ <= p.lng_ &&
+             p.lng_ <= max_lng_;
     }
-  }
 
-  point_rtree& operator=(point_rtree const&) = delete;
-  point_rtree& operator=(point_rtree&& o) {
-    if (this != &o) {
-      rtree_ = o.rtree_;
-      o.rtree_ = nullptr;
+    void extend(bbox const& o) {
+      min_lat_ = std::min(min_lat_, o.min_lat_);
+      min_lng_ = std::min(min_lng_, o.min_lng_);
+      max_lat_ = std::max(max_lat_, o.max_lat_);
+      max_lng_ = std::max(max_lng_, o.max_lng_);
     }
-    return *this;
-  }
 
-  void add(geo::latlng const& pos, T const t) {
-    auto const min_corner = std::array{pos.lng(), pos.lat()};
-    rtree_insert(
-        rtree_, min_corner.data(), nullptr,
-        reinterpret_cast<void*>(static_cast<std::size_t>(cista::to_idx(t))));
+    // Lower bound for the distance [meters] from `p` to any point inside.
+    double min_distance(geo::latlng const& p) const {
+      return geo::distance(p, {std::clamp(p.lat_, min_lat_, max_lat_),
+                               std::clamp(p.lng_, min_lng_, max_lng_)});
+    }
+
+    static bbox of(geo::latlng const& p) {
+      return {p.lat_, p.lng_, p.lat_, p.lng_};
+    }
+
+    static bbox of(geo::box const& b) {
+      return {b.min_.lat_, b.min_.lng_, b.max_.lat_, b.max_.lng_};
+    }
+
+    double min_lat_, min_lng_, max_lat_, max_lng_;
+  };
+
+  point_rtree() = default;
+
+  explicit point_rtree(std::vector<entry> entries) {
+    if (entries.empty()) {
+      return;
+    }
+
+    auto extent = bbox::of(entries.front().pos_);
+    for (auto const& e : entries) {
+      extent.extend(bbox::of(e.pos_));
+    }
+    auto const hilbert_value = [&](geo::latlng const& p) {
+      constexpr auto const kMax = double{(1U << 16U) - 1U};
+      auto const lat_range = std::max(extent.max_lat_ - extent.min_lat_, 1E-9);
+      auto const lng_range = std::max(extent.max_lng_ - extent.min_lng_, 1E-9);
+      return hilbert(
+          static_cast<std::uint32_t>(kMax * (p.lng_ - extent.min_lng_) /
+                                     lng_range),
+          static_cast<std::uint32_t>(kMax * (p.lat_ - extent.min_lat_) /
+                                     lat_range));
+    };
+
+    auto order = std::vector<std::pair<std::uint32_t, std::uint32_t>>{};
+    order.reserve(entries.size());
+    for (auto i = 0U; i != entries.size(); ++i) {
+      order.emplace_back(hilbert_value(entries[i].pos_), i);
+    }
+    std::sort(begin(order), end(order));
+
+    pos_.reserve(entries.size());
+    items_.reserve(entries.size());
+    for (auto const& [_, i] : order) {
+      pos_.push_back(entries[i].pos_);
+      items_.push_back(entries[i].item_);
+    }
+
+    // Level 0 covers the points, every further level covers the one below.
+    auto level_size = static_cast<std::uint32_t>(pos_.size());
+    auto const get_child_box = [&](unsigned const level, std::uint32_t i) {
+      return level == 0U ? bbox::of(pos_[i])
+                         : boxes_[level_start_[level - 1U] + i];
+    };
+    for (auto level = 0U; level == 0U || level_size > 1U; ++level) {
+      auto const n_nodes = (level_size + kNodeSize - 1U) / kNodeSize;
+      level_start_.push_back(static_cast<std::uint32_t>(boxes_.size()));
+      for (auto node = 0U; node != n_nodes; ++node) {
+        auto const from = node * kNodeSize;
+        auto const to = std::min(level_size, from + kNodeSize);
+        auto b = get_child_box(level, from);
+        for (auto i = from + 1U; i < to; ++i) {
+          b.extend(get_child_box(level, i));
+        }
+        boxes_.push_back(b);
+      }
+      level_size = n_nodes;
+    }
+    level_start_.push_back(static_cast<std::uint32_t>(boxes_.size()));
   }
 
+  std::size_t size() const { return items_.size(); }
+  bool empty() const { return items_.empty(); }
+
   std::vector<T> in_radius(geo::latlng const& x, double distance) const {
     auto ret = std::vector<T>{};
     in_radius(x, distance, [&](auto&& item) { ret.emplace_back(item); });
@@ -58,42 +149,161 @@ struct point_rtree {
 
   template <typename Fn>
   void in_radius(geo::latlng const& x, double distance, Fn&& fn) const {
-    find(x, [&](geo::latlng const& pos, T const item) {
-      if (geo::distance(x, pos) < distance) {
-        fn(item);
+    // Leaves are checked in one batch with the approximate distance kernel.
+    // Only entries close to the border need the exact distance.
+    auto dist = std::array<double, kNodeSize>{};
+    for_each_leaf(bbox::of(geo::box{x, distance}), [&](std::uint32_t const from,
+                                                       std::uint32_t const to) {
+      approx_distances(x, {pos_.data() + from, to - from}, dist);
+      for (auto i = from; i != to; ++i) {
+        auto const d = dist[i - from];
+        if (d < distance * (1.0 - kApproxTolerance) ||
+            (d < distance * (1.0 + kApproxTolerance) &&
+             geo::distance(x, pos_[i]) < distance)) {
+          fn(items_[i]);
+        }
+      }
+    });
+  }
+
+  // Closest entry not further away than `max_distance` [meters].
+  std::optional<T> nearest(geo::latlng const& x, double max_distance) const {
+    auto const k = k_nearest(x, 1U, max_distance);
+    return k.empty() ? std::nullopt : std::optional{k.front()};
+  }
+
+  // The `k` closest entries (nearest first), at most `max_distance` away.
+  std::vector<T> k_nearest(
+      geo::latlng const& x,
+      std::size_t const k,
+      double const max_distance = std::numeric_limits<double>::max()) const {
+    struct candidate {
+      bool operator<(candidate const& o) const { return dist_ > o.dist_; }
+      double dist_;
+      unsigned level_;  // 0 = point, otherwise level + 1
+      std::uint32_t idx_;
+    };
+
+    auto ret = std::vector<T>{};
+    if (empty() || k == 0U) {
+      return ret;
+    }
+
+    auto pq = std::priority_queue<candidate>{};
+    auto const root_level = static_cast<unsigned>(level_start_.size() - 2U);
+    pq.push({boxes_.back().min_distance(x), root_level + 1U, 0U});
+    while (!pq.empty() && ret.size() < k) {
+      auto const c = pq.top();
+      pq.pop();
+      if (c.dist_ > max_distance) {
+        break;
+      }
+      if (c.level_ == 0U) {
+        ret.push_back(items_[c.idx_]);
+        continue;
+      }
+      for_each_child(c.level_ - 1U, c.idx_, [&](unsigned const child_level,
+                                                std::uint32_t const i) {
+        pq.push(child_level == 0U
+                    ? candidate{geo::distance(x, pos_[i]), 0U, i}
+                    : candidate{
+                          boxes_[level_start_[child_level - 1U] + i]
+                              .min_distance(x),
+                          child_level, i});
+      });
+    }
+    return ret;
+  }
+
+  template <typename Fn>
+  void find(geo::box const& query, Fn&& fn) const {
+    auto const q = bbox::of(query);
+    for_each_leaf(q, [&](std::uint32_t const from, std::uint32_t const to) {
+      for (auto i = from; i != to; ++i) {
+        if (!q.contains(pos_[i])) {
+          continue;
+        }
+        if constexpr (RtreePosHandler<T, Fn>) {
+          fn(pos_[i], items_[i]);
+        } else {
+          fn(items_[i]);
+        }
       }
     });
   }
 
+  // Calls fn(from, to) with the entry range of every leaf overlapping `q`.
   template <typename Fn>
-  void find(geo::latlng const& x, Fn&& fn) const {
-    find({{x.lat() - 0.01, x.lng() - 0.01}, {x.lat() + 0.01, x.lng() + 0.01}},
-         std::forward<Fn>(fn));
+  void for_each_leaf(bbox const& q, Fn&& fn) const {
+    if (empty() || !boxes_.back().overlaps(q)) {
+      return;
+    }
+
+    // Depth-first, at most kNodeSize entries per level are pending.
+    auto stack =
+        std::array<std::pair<unsigned, std::uint32_t>, kNodeSize * kMaxDepth>{};
+    auto stack_size = 0U;
+    stack[stack_size++] = {static_cast<unsigned>(level_start_.size() - 2U), 0U};
+    while (stack_size != 0U) {
+      auto const [level, node] = stack[--stack_size];
+      if (level == 0U) {
+        auto const from = node * kNodeSize;
+        fn(from, std::min(static_cast<std::uint32_t>(pos_.size()),
+                          from + kNodeSize));
+        continue;
+      }
+      for_each_child(level, node, [&](unsigned const child_level,
+                                      std::uint32_t const i) {
+        if (boxes_[level_start_[child_level - 1U] + i].overlaps(q)) {
+          stack[stack_size++] = {child_level - 1U, i};
+        }
+      });
+    }
   }
 
+  // Calls fn(child_level, child_idx) for every child of `node` on `level`.
+  // child_level 0 are the points, child_level l > 0 is boxes level l - 1.
   template <typename Fn>
-  void find(geo::box const& b, Fn&& fn) const {
-    auto const min = b.min_.lnglat();
-    auto const max = b.max_.lnglat();
-    rtree_search(
-        rtree_, min.data(), max.data(),
-        [](double const* pos, double const* /* max */, void const* item,
-           void* udata) {
-          if constexpr (RtreePosHandler<T, Fn>) {
-            (*reinterpret_cast<Fn*>(udata))(
-                geo::latlng{pos[1], pos[0]},
-                T{static_cast<cista::base_t<T>>(
-                    reinterpret_cast<std::size_t>(item))});
-          } else {
-            (*reinterpret_cast<Fn*>(udata))(T{static_cast<cista::base_t<T>>(
-                reinterpret_cast<std::size_t>(item))});
-          }
-          return true;
-        },
-        &fn);
+  void for_each_child(unsigned const level,
+                      std::uint32_t const node,
+                      Fn&& fn) const {
+    auto const n_children =
+        level == 0U ? static_cast<std::uint32_t>(pos_.size())
+                    : level_start_[level] - level_start_[level - 1U];
+    auto const from = node * kNodeSize;
+    auto const to = std::min(n_children, from + kNodeSize);
+    for (auto i = from; i < to; ++i) {
+      fn(level, i);
+    }
+  }
+
+  static std::uint32_t hilbert(std::uint32_t x, std::uint32_t y) {
+    auto d = std::uint32_t{0U};
+    for (auto s = std::uint32_t{1U} << 15U; s > 0U; s >>= 1U) {
+      auto const rx = (x & s) > 0U ? 1U : 0U;
+      auto const ry = (y & s) > 0U ? 1U : 0U;
+      d += s * s * ((3U * rx) ^ ry);
+      if (ry == 0U) {
+        if (rx == 1U) {
+          x = s - 1U - (x & (s - 1U));
+          y = s - 1U - (y & (s - 1U));
+        }
+        std::swap(x, y);
+      }
+      x &= s - 1U;
+      y &= s - 1U;
+    }
+    return d;
+  }
+
+  auto cista_members() {
+    return std::tie(pos_, items_, boxes_, level_start_);
   }
 
-  rtree* rtree_{nullptr};
+  cista::raw::vector<geo::latlng> pos_;
+  cista::raw::vector<T> items_;
+  cista::raw::vector<bbox> boxes_;
+  cista::raw::vector<std::uint32_t> level_start_;
 };
 
 }  // namespace motis
\ No newline at end of file
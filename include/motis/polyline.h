@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cinttypes>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "geo/latlng.h"
+
+namespace motis {
+
+// Douglas-Peucker simplification: appends the points of `line` to `out`
+// dropping every point that is less than `tolerance` meters away from the
+// simplified line. First and last point are always kept.
+void simplify(std::span<geo::latlng const> line,
+              double tolerance,
+              std::vector<geo::latlng>& out);
+
+std::vector<geo::latlng> simplify(std::span<geo::latlng const> line,
+                                  double tolerance);
+
+// Same as above, result and scratch memory are taken from `mr`.
+std::pmr::vector<geo::latlng> simplify(std::span<geo::latlng const> line,
+                                       double tolerance,
+                                       std::pmr::memory_resource* mr);
+
+// Checks the range of a precision request parameter.
+unsigned to_polyline_precision(std::int64_t);
+
+// Google polyline encoding with `precision` decimal places.
+std::string encode_polyline(std::span<geo::latlng const>, unsigned precision);
+
+}  // namespace motis
\ No newline at end of file
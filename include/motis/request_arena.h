@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace motis {
+
+// Monotonic allocator for temporaries of a single request. Everything is
+// released at once when the arena is destroyed. The initial buffer is kept
+// per thread and grows to the largest request seen so far (up to
+// kMaxArenaSize), so in steady state requests do not hit the global heap.
+struct request_arena {
+  static constexpr auto const kInitialArenaSize = std::size_t{256U * 1024U};
+  static constexpr auto const kMaxArenaSize = std::size_t{64U * 1024U * 1024U};
+
+  request_arena();
+  ~request_arena();
+
+  request_arena(request_arena const&) = delete;
+  request_arena(request_arena&&) = delete;
+  request_arena& operator=(request_arena const&) = delete;
+  request_arena& operator=(request_arena&&) = delete;
+
+  std::pmr::memory_resource* get() { return &mono_; }
+
+private:
+  // Counts what did not fit into the thread's buffer.
+  struct overflow_resource : public std::pmr::memory_resource {
+    void* do_allocate(std::size_t, std::size_t) override;
+    void do_deallocate(void*, std::size_t, std::size_t) override;
+    bool do_is_equal(std::pmr::memory_resource const&) const noexcept override;
+
+    std::size_t allocated_{0U};
+  };
+
+  bool owns_thread_buffer_;
+  overflow_resource overflow_;
+  std::pmr::monotonic_buffer_resource mono_;
+};
+
+}  // namespace motis
\ No newline at end of file
@@ -9,6 +9,7 @@ namespace motis {
 boost::asio::awaitable<void> rt_update(config const&,
                                        nigiri::timetable const&,
                                        tag_lookup const& tags,
-                                       std::shared_ptr<rt>&);
+                                       std::shared_ptr<rt>&,
+                                       itinerary_watch&);
 
 }
\ No newline at end of file
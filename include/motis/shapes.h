@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <span>
+
+#include "cista/mmap.h"
+
+#include "geo/latlng.h"
+
+#include "nigiri/shape.h"
+#include "nigiri/types.h"
+
+#include "osr/types.h"
+
+#include "motis/fwd.h"
+
+namespace motis {
+
+// Trip geometries, pre-simplified for every tolerance [meters] in `kLevels`.
+// Each transport range of a trip has its own entry (its stops may differ).
+// Ranges with the same source shape and stop positions share one entry.
+// Each entry stores the index of every stop in the polyline of every level
+// so that legs can be sliced without allocations.
+struct shapes {
+  static constexpr auto const kLevels = std::array{0.0, 2.0, 10.0, 50.0};
+  static constexpr auto const kNumLevels = kLevels.size();
+
+  using shape_idx_t = cista::strong<std::uint32_t, struct shape_idx_>;
+  using bucket_idx_t = cista::strong<std::uint32_t, struct shape_bucket_idx_>;
+
+  shapes(std::filesystem::path, cista::mmap::protection);
+
+  // Coarsest level with a tolerance not above the requested one.
+  static unsigned get_level(double tolerance);
+
+  // Geometry of the stops [from, to) of transport `t` serving trip `trip`.
+  // Empty if the trip has no shape.
+  std::span<geo::latlng const> get(nigiri::timetable const&,
+                                   nigiri::trip_idx_t trip,
+                                   nigiri::transport_idx_t t,
+                                   nigiri::interval<nigiri::stop_idx_t>,
+                                   unsigned level) const;
+
+  cista::mmap mm(char const* file);
+
+  std::filesystem::path p_;
+  cista::mmap::protection mode_;
+
+  // trip -> shape of each range in `tt.trip_transport_ranges_[trip]`
+  // (empty if the trip has no shape)
+  osr::mm_vecvec<nigiri::trip_idx_t, shape_idx_t, std::uint64_t> trip_shape_;
+
+  // shape * kNumLevels + level -> simplified polyline
+  osr::mm_vecvec<bucket_idx_t, geo::latlng, std::uint64_t> points_;
+
+  // shape * kNumLevels + level -> index of each stop in `points_`
+  osr::mm_vecvec<bucket_idx_t, std::uint32_t, std::uint64_t> offsets_;
+};
+
+void build_shapes(nigiri::timetable const&,
+                  nigiri::shape_storage_t const&,
+                  std::filesystem::path const&);
+
+}  // namespace motis
\ No newline at end of file
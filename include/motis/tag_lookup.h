@@ -19,17 +19,23 @@ struct tag_lookup {
 
   nigiri::source_idx_t get_src(std::string_view tag) const;
   std::string_view get_tag(nigiri::source_idx_t) const;
-  std::string id(nigiri::timetable const&, nigiri::location_idx_t) const;
-  std::string id(nigiri::timetable const&, nigiri::trip_idx_t) const;
+  std::string_view id(nigiri::location_idx_t) const;
+  std::string_view id(nigiri::trip_idx_t) const;
   std::string id(nigiri::trip_id const&) const;
   nigiri::location_idx_t get(nigiri::timetable const&, std::string_view) const;
 
+  // Precomputes the tagged ("{tag}_{id}") stop and trip ids.
+  // Has to be called once after the timetable is loaded.
+  void build_ids(nigiri::timetable const&);
+
   friend std::ostream& operator<<(std::ostream&, tag_lookup const&);
   void write(std::filesystem::path const&) const;
   static cista::wrapped<tag_lookup> read(std::filesystem::path const&);
 
   nigiri::vecvec<nigiri::source_idx_t, char, std::uint32_t> src_to_tag_;
   nigiri::hash_map<nigiri::string, nigiri::source_idx_t> tag_to_src_;
+  nigiri::vecvec<nigiri::location_idx_t, char, std::uint32_t> location_ids_;
+  nigiri::vecvec<nigiri::trip_idx_t, char, std::uint32_t> trip_ids_;
 };
 
 }  // namespace motis
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+
+#include "nigiri/common/interval.h"
+#include "nigiri/types.h"
+
+#include "motis/fwd.h"
+#include "motis/types.h"
+
+namespace motis {
+
+struct trip_id_index {
+  using entry_t = nigiri::pair<nigiri::trip_id_idx_t, nigiri::trip_idx_t>;
+
+  explicit trip_id_index(nigiri::timetable const&);
+
+  // All (trip_id_idx, trip_idx) entries of `tt.trip_id_to_idx_` with the
+  // given source and trip id. Empty if the trip id is unknown.
+  std::span<entry_t const> find(nigiri::timetable const&,
+                                nigiri::source_idx_t,
+                                std::string_view trip_id) const;
+
+  hash_map<std::pair<nigiri::source_idx_t, std::string_view>,
+           nigiri::interval<std::uint32_t>>
+      ranges_;
+};
+
+}  // namespace motis
\ No newline at end of file
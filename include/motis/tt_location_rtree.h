@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "nigiri/timetable.h"
 
 #include "motis/point_rtree.h"
@@ -8,13 +10,13 @@ namespace motis {
 
 inline point_rtree<nigiri::location_idx_t> create_location_rtree(
     nigiri::timetable const& tt) {
-  auto t = point_rtree<nigiri::location_idx_t>{};
+  auto entries = std::vector<point_rtree<nigiri::location_idx_t>::entry>{};
   for (auto i = nigiri::location_idx_t{0U}; i != tt.n_locations(); ++i) {
     if (!tt.location_routes_[i].empty()) {
-      t.add(tt.locations_.coordinates_[i], i);
+      entries.push_back({tt.locations_.coordinates_[i], i});
     }
   }
-  return t;
+  return point_rtree<nigiri::location_idx_t>{std::move(entries)};
 }
 
 }  // namespace motis
\ No newline at end of file
@@ -26,11 +26,9 @@ osr::bitvec<osr::node_idx_t>& set_blocked(nodes_t const&,
 std::vector<nigiri::td_footpath> get_td_footpaths(
     osr::ways const&,
     osr::lookup const&,
-    osr::platforms const&,
-    nigiri::timetable const&,
     point_rtree<nigiri::location_idx_t> const&,
     elevators const&,
-    platform_matches_t const&,
+    location_positions_t const&,
     nigiri::location_idx_t start_l,
     osr::location start,
     osr::direction,
@@ -47,11 +45,10 @@ std::optional<std::pair<nodes_t, states_t>> get_states_at(osr::ways const&,
 void update_rtt_td_footpaths(
     osr::ways const&,
     osr::lookup const&,
-    osr::platforms const&,
     nigiri::timetable const&,
     point_rtree<nigiri::location_idx_t> const&,
     elevators const&,
-    platform_matches_t const&,
+    location_positions_t const&,
     hash_set<std::pair<nigiri::location_idx_t, osr::direction>> const& tasks,
     nigiri::rt_timetable const* old_rtt,
     nigiri::rt_timetable&,
@@ -59,12 +56,11 @@ void update_rtt_td_footpaths(
 
 void update_rtt_td_footpaths(osr::ways const&,
                              osr::lookup const&,
-                             osr::platforms const&,
                              nigiri::timetable const&,
                              point_rtree<nigiri::location_idx_t> const&,
                              elevators const&,
                              elevator_footpath_map_t const&,
-                             platform_matches_t const&,
+                             location_positions_t const&,
                              nigiri::rt_timetable&,
                              std::chrono::seconds max);
 
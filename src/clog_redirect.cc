@@ -1,23 +1,77 @@
 #include "motis/clog_redirect.h"
 
 #include <iostream>
+#include <mutex>
 
 namespace motis {
 
-clog_redirect::clog_redirect(char const* log_file_path)
-    : backup_clog_{std::clog.rdbuf()} {
+namespace {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+thread_local std::streambuf* thread_sink = nullptr;
+
+// Unbuffered std::clog buffer forwarding to the sink of the writing thread
+// or - if there is none - to the original std::clog buffer. Threads without
+// a sink (e.g. worker threads started by a task) share the original buffer,
+// writes to it are serialized.
+struct thread_streambuf : public std::streambuf {
+  explicit thread_streambuf(std::streambuf* fallback) : fallback_{fallback} {}
+
+  template <typename Fn>
+  auto write(Fn&& fn) {
+    if (thread_sink != nullptr) {
+      return fn(thread_sink);
+    }
+    auto const lock = std::scoped_lock{mutex_};
+    return fn(fallback_);
+  }
+
+  int_type overflow(int_type const c) override {
+    return traits_type::eq_int_type(c, traits_type::eof())
+               ? traits_type::not_eof(c)
+               : write([&](std::streambuf* b) {
+                   return b->sputc(traits_type::to_char_type(c));
+                 });
+  }
+
+  std::streamsize xsputn(char const* s, std::streamsize const n) override {
+    return write([&](std::streambuf* b) { return b->sputn(s, n); });
+  }
+
+  int sync() override {
+    return write([](std::streambuf* b) { return b->pubsync(); });
+  }
+
+  std::mutex mutex_;
+  std::streambuf* fallback_;
+};
+
+void install_thread_streambuf() {
+  static auto once = std::once_flag{};
+  std::call_once(once, []() {
+    static auto buf = thread_streambuf{std::clog.rdbuf()};
+    std::clog.rdbuf(&buf);
+  });
+}
+
+}  // namespace
+
+clog_redirect::clog_redirect(char const* log_file_path) {
   if (!enabled_) {
     return;
   }
 
   sink_.exceptions(std::ios_base::badbit | std::ios_base::failbit);
   sink_.open(log_file_path, std::ios_base::app);
-  std::clog.rdbuf(sink_.rdbuf());
+  install_thread_streambuf();
+  prev_sink_ = thread_sink;
+  thread_sink = sink_.rdbuf();
+  active_ = true;
 }
 
 clog_redirect::~clog_redirect() {
-  if (enabled_) {
-    std::clog.rdbuf(backup_clog_);
+  if (active_) {
+    thread_sink = prev_sink_;
   }
 }
 
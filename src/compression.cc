@@ -0,0 +1,108 @@
+#include "motis/compression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <optional>
+
+#include "boost/beast/zlib/deflate_stream.hpp"
+#include "boost/crc.hpp"
+
+#include "utl/verify.h"
+
+namespace zlib = boost::beast::zlib;
+
+namespace motis {
+
+namespace {
+
+bool iequals(std::string_view a, std::string_view b) {
+  return std::equal(begin(a), end(a), begin(b), end(b),
+                    [](char const x, char const y) {
+                      return std::tolower(static_cast<unsigned char>(x)) ==
+                             std::tolower(static_cast<unsigned char>(y));
+                    });
+}
+
+std::string_view trim(std::string_view s) {
+  auto const first = s.find_first_not_of(" \t");
+  if (first == std::string_view::npos) {
+    return {};
+  }
+  return s.substr(first, s.find_last_not_of(" \t") - first + 1U);
+}
+
+void append_le32(std::string& out, std::uint32_t const x) {
+  for (auto i = 0U; i != 4U; ++i) {
+    out.push_back(static_cast<char>((x >> (i * 8U)) & 0xFFU));
+  }
+}
+
+}  // namespace
+
+bool accepts_gzip(std::string_view accept_encoding) {
+  auto gzip_q = std::optional<double>{};
+  auto any_q = std::optional<double>{};
+  while (!accept_encoding.empty()) {
+    auto const comma = accept_encoding.find(',');
+    auto const entry = trim(accept_encoding.substr(0U, comma));
+    accept_encoding = comma == std::string_view::npos
+                          ? std::string_view{}
+                          : accept_encoding.substr(comma + 1U);
+
+    auto const semicolon = entry.find(';');
+    auto const coding = trim(entry.substr(0U, semicolon));
+    auto params = semicolon == std::string_view::npos
+                      ? std::string_view{}
+                      : entry.substr(semicolon + 1U);
+    auto q = 1.0;
+    while (!params.empty()) {
+      auto const next = params.find(';');
+      auto const param = trim(params.substr(0U, next));
+      params = next == std::string_view::npos ? std::string_view{}
+                                              : params.substr(next + 1U);
+      if (param.size() > 2U && iequals(param.substr(0U, 2U), "q=")) {
+        std::from_chars(param.data() + 2U, param.data() + param.size(), q);
+      }
+    }
+
+    if (iequals(coding, "gzip") || iequals(coding, "x-gzip")) {
+      gzip_q = std::max(gzip_q.value_or(0.0), q);
+    } else if (coding == "*") {
+      any_q = std::max(any_q.value_or(0.0), q);
+    }
+  }
+  return gzip_q.value_or(any_q.value_or(0.0)) > 0.0;
+}
+
+std::string gzip(std::string_view in) {
+  auto ds = zlib::deflate_stream{};
+  ds.reset(6, 15, 8, zlib::Strategy::normal);
+
+  auto out = std::string{};
+  out.resize(10U + ds.upper_bound(in.size()) + 8U);
+
+  // gzip header: magic, deflate, no flags, no mtime, no extra flags, unknown OS
+  constexpr char const kHeader[] = {'\x1F', '\x8B', '\x08', '\x00', '\x00',
+                                    '\x00', '\x00', '\x00', '\x00', '\xFF'};
+  std::copy(std::begin(kHeader), std::end(kHeader), begin(out));
+
+  auto zs = zlib::z_params{};
+  zs.next_in = in.data();
+  zs.avail_in = in.size();
+  zs.next_out = out.data() + 10U;
+  zs.avail_out = out.size() - 10U;
+
+  auto ec = boost::system::error_code{};
+  ds.write(zs, zlib::Flush::finish, ec);
+  utl::verify(ec == zlib::error::end_of_stream, "gzip: {}", ec.message());
+  out.resize(10U + zs.total_out);
+
+  auto crc = boost::crc_32_type{};
+  crc.process_bytes(in.data(), in.size());
+  append_le32(out, crc.checksum());
+  append_le32(out, static_cast<std::uint32_t>(in.size()));
+  return out;
+}
+
+}  // namespace motis
\ No newline at end of file
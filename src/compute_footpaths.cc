@@ -1,9 +1,15 @@
 #include "motis/compute_footpaths.h"
 
+#include <algorithm>
+#include <atomic>
+
 #include "cista/mmap.h"
 #include "cista/serialization.h"
 
+#include "utl/helpers/algorithm.h"
 #include "utl/parallel_for.h"
+#include "utl/to_vec.h"
+#include "utl/zip.h"
 
 #include "osr/routing/profiles/foot.h"
 #include "osr/routing/route.h"
@@ -11,20 +17,20 @@
 #include "osr/util/reverse.h"
 
 #include "motis/constants.h"
-#include "motis/get_loc.h"
-#include "motis/match_platforms.h"
+#include "motis/footpath_checkpoint.h"
+#include "motis/parallel_for.h"
 #include "motis/point_rtree.h"
 
+namespace fs = std::filesystem;
 namespace n = nigiri;
 
 namespace motis {
 
 vector_map<n::location_idx_t, osr::match_t> lookup_locations(
-    osr::ways const& w,
     osr::lookup const& lookup,
-    osr::platforms const& pl,
     n::timetable const& tt,
-    platform_matches_t const& matches,
+    location_positions_t const& positions,
+    std::span<n::location_idx_t const> locations,
     osr::search_profile const profile) {
   auto const timer = utl::scoped_timer{fmt::format(
       "matching timetable locations for profile={}", to_str(profile))};
@@ -32,163 +38,301 @@ vector_map<n::location_idx_t, osr::match_t> lookup_locations(
   auto ret = vector_map<n::location_idx_t, osr::match_t>{};
   ret.resize(tt.n_locations());
 
-  utl::parallel_for_run(tt.n_locations(), [&](std::size_t const x) {
-    auto const l =
-        n::location_idx_t{static_cast<n::location_idx_t::value_t>(x)};
+  // Stations with many routes are in dense areas where matching is slower.
+  auto const costs = utl::to_vec(locations, [&](n::location_idx_t const l) {
+    return static_cast<std::uint32_t>(tt.location_routes_[l].size());
+  });
+  parallel_for_by_cost(costs, [&](std::size_t const x) {
+    auto const l = locations[x];
     // - fixed `direction=forward` only works because we don't reconstruct and
     //   because foot/wheelchair can use ways
     // - fixed `reverse=false` only works because foot/wheelchair can use ways
     //   in both directions.
-    ret[l] = lookup.match(get_loc(tt, w, pl, matches, l), false,
-                          osr::direction::kForward, kMaxMatchingDistance,
-                          nullptr, profile);
+    ret[l] = lookup.match(positions[l], false, osr::direction::kForward,
+                          kMaxMatchingDistance, nullptr, profile);
   });
 
   return ret;
 }
 
+constexpr auto const kCheckpointRange = 10'000U;
+
+// Fills the outgoing and ingoing vecvecs in place. The ingoing footpaths
+// are bucketed by target with a parallel counting sort.
+template <typename VecVec>
+void write_footpaths(footpaths_t const& out, VecVec& out_vv, VecVec& in_vv) {
+  using index_t = typename decltype(out_vv.bucket_starts_)::value_type;
+
+  auto const n_locations = out.size();
+  auto const get_out =
+      [&](std::size_t const i) -> std::vector<n::footpath> const& {
+    return out[n::location_idx_t{static_cast<std::uint32_t>(i)}];
+  };
+
+  auto n_in = std::vector<std::atomic<index_t>>(n_locations);
+  out_vv.bucket_starts_.resize(n_locations + 1U);
+  out_vv.bucket_starts_[0] = index_t{0U};
+  for (auto i = 0U; i != n_locations; ++i) {
+    out_vv.bucket_starts_[i + 1U] = static_cast<index_t>(
+        out_vv.bucket_starts_[i] + get_out(i).size());
+  }
+  out_vv.data_.resize(out_vv.bucket_starts_.back());
+  utl::parallel_for_run(n_locations, [&](std::size_t const i) {
+    auto const& fps = get_out(i);
+    std::copy(begin(fps), end(fps),
+              begin(out_vv.data_) + out_vv.bucket_starts_[i]);
+    for (auto const& fp : fps) {
+      n_in[to_idx(fp.target())].fetch_add(1U, std::memory_order_relaxed);
+    }
+  });
+
+  auto next = std::vector<std::atomic<index_t>>(n_locations);
+  in_vv.bucket_starts_.resize(n_locations + 1U);
+  in_vv.bucket_starts_[0] = index_t{0U};
+  for (auto i = 0U; i != n_locations; ++i) {
+    next[i] = in_vv.bucket_starts_[i];
+    in_vv.bucket_starts_[i + 1U] =
+        static_cast<index_t>(in_vv.bucket_starts_[i] + n_in[i]);
+  }
+  in_vv.data_.resize(in_vv.bucket_starts_.back());
+  utl::parallel_for_run(n_locations, [&](std::size_t const i) {
+    auto const l = n::location_idx_t{static_cast<std::uint32_t>(i)};
+    for (auto const& fp : get_out(i)) {
+      auto const pos = next[to_idx(fp.target())].fetch_add(
+          1U, std::memory_order_relaxed);
+      in_vv.data_[pos] = n::footpath{l, fp.duration()};
+    }
+  });
+
+  // Scatter order depends on thread timing: sort buckets by source.
+  utl::parallel_for_run(n_locations, [&](std::size_t const i) {
+    std::sort(begin(in_vv.data_) + in_vv.bucket_starts_[i],
+              begin(in_vv.data_) + in_vv.bucket_starts_[i + 1U]);
+  });
+}
+
 elevator_footpath_map_t compute_footpaths(osr::ways const& w,
                                           osr::lookup const& lookup,
-                                          osr::platforms const& pl,
                                           nigiri::timetable& tt,
-                                          bool const update_coordinates) {
-  fmt::println(std::clog, "  -> creating matches");
-  auto const matches = get_matches(tt, pl, w);
-
+                                          platform_centers_t const& centers,
+                                          platform_matches_t const& matches,
+                                          location_positions_t const& positions,
+                                          footpath_options const& opt) {
   fmt::println(std::clog, "  -> creating r-tree");
   auto const loc_rtree = [&]() {
-    auto t = point_rtree<n::location_idx_t>{};
+    auto entries = std::vector<point_rtree<n::location_idx_t>::entry>{};
     for (auto i = n::location_idx_t{0U}; i != tt.n_locations(); ++i) {
-      if (update_coordinates && matches[i] != osr::platform_idx_t::invalid()) {
-        auto const center = get_platform_center(pl, w, matches[i]);
-        if (center.has_value() &&
-            geo::distance(*center, tt.locations_.coordinates_[i]) <
-                kMaxAdjust) {
-          tt.locations_.coordinates_[i] = *center;
+      if (opt.update_coordinates_ &&
+          matches[i] != osr::platform_idx_t::invalid()) {
+        auto const center = centers[matches[i]];
+        if (geo::distance(center, tt.locations_.coordinates_[i]) <
+            kMaxAdjust) {
+          tt.locations_.coordinates_[i] = center;
         }
       }
 
       if (!tt.location_routes_[i].empty()) {
-        t.add(tt.locations_.coordinates_[i], i);
+        entries.push_back({tt.locations_.coordinates_[i], i});
       }
     }
-    return t;
+    return point_rtree<n::location_idx_t>{std::move(entries)};
   }();
 
-  auto const pt = utl::get_active_progress_tracker();
-  pt->in_high(tt.n_locations() * 2U);
+  auto const get_neighbors = [&](n::location_idx_t const l) {
+    auto neighbors = std::vector<n::location_idx_t>{};
+    loc_rtree.in_radius(tt.locations_.coordinates_[l], kMaxDistance,
+                        [&](n::location_idx_t const x) {
+                          if (x != l) {
+                            neighbors.emplace_back(x);
+                          }
+                        });
+    return neighbors;
+  };
+
+  // Locations to compute footpaths for.
+  auto const locations = [&]() {
+    if (opt.locations_.has_value()) {
+      return *opt.locations_;
+    }
+    auto all = std::vector<n::location_idx_t>{};
+    all.reserve(tt.n_locations());
+    for (auto i = n::location_idx_t{0U}; i != tt.n_locations(); ++i) {
+      all.push_back(i);
+    }
+    return all;
+  }();
 
-  auto footpaths_out_foot =
-      n::vector_map<n::location_idx_t, std::vector<n::footpath>>{};
+  auto const pt =
+      opt.pt_ != nullptr ? opt.pt_ : utl::get_active_progress_tracker();
+  pt->in_high(locations.size() * 2U);
+
+  auto footpaths_out_foot = footpaths_t{};
   footpaths_out_foot.resize(tt.n_locations());
-  auto footpaths_out_wheelchair =
-      n::vector_map<n::location_idx_t, std::vector<n::footpath>>{};
+  auto footpaths_out_wheelchair = footpaths_t{};
   footpaths_out_wheelchair.resize(tt.n_locations());
 
-  auto elevator_in_paths_mutex = std::mutex{};
   auto elevator_in_paths = elevator_footpath_map_t{};
-  auto const add_if_elevator = [&](osr::node_idx_t const n,
+
+  // Locations stored in a checkpoint are not computed again.
+  auto done = std::array<std::vector<bool>, 2U>{};
+  done[0].resize(tt.n_locations());
+  done[1].resize(tt.n_locations());
+  auto const restore = [&](std::vector<footpath_checkpoint::range> const& rs) {
+    auto n_restored = 0U;
+    for (auto const& r : rs) {
+      auto& out = r.profile_ == 0U ? footpaths_out_foot
+                                   : footpaths_out_wheelchair;
+      for (auto const [l, fps] : utl::zip(r.locations_, r.footpaths_)) {
+        out[l] = fps;
+        done[r.profile_][to_idx(l)] = true;
+      }
+      for (auto const& e : r.elevator_paths_) {
+        elevator_in_paths[e.node_].emplace(e.from_, e.to_);
+      }
+      n_restored += static_cast<unsigned>(r.locations_.size());
+    }
+    return n_restored;
+  };
+
+  for (auto const& p : opt.shard_results_) {
+    fmt::println(std::clog, "  -> {}: {} results", p.generic_string(),
+                 restore(footpath_checkpoint::read(p, opt.checkpoint_key_)));
+  }
+
+  auto checkpoint = std::optional<footpath_checkpoint>{};
+  if (!opt.checkpoint_.empty()) {
+    checkpoint.emplace(opt.checkpoint_, opt.checkpoint_key_);
+    fmt::println(std::clog, "  -> checkpoint: {} results",
+                 restore(checkpoint->read()));
+  }
+
+  // Candidates are needed for all locations with open work and their
+  // neighbors (the halo of a shard).
+  auto const matched = [&]() {
+    auto const is_done = [&](n::location_idx_t const l) {
+      return done[0][to_idx(l)] && done[1][to_idx(l)];
+    };
+    if (!opt.locations_.has_value() && utl::none_of(locations, is_done)) {
+      return locations;
+    }
+    auto ret = hash_set<n::location_idx_t>{};
+    for (auto const l : locations) {
+      if (!is_done(l)) {
+        ret.emplace(l);
+        for (auto const x : get_neighbors(l)) {
+          ret.emplace(x);
+        }
+      }
+    }
+    return std::vector<n::location_idx_t>{begin(ret), end(ret)};
+  }();
+
+  auto const foot_candidates = lookup_locations(lookup, tt, positions, matched,
+                                                osr::search_profile::kFoot);
+  auto const wheelchair_candidates = lookup_locations(
+      lookup, tt, positions, matched, osr::search_profile::kWheelchair);
+
+  using elevator_paths_t = std::vector<footpath_checkpoint::elevator_path>;
+  auto const add_if_elevator = [&](elevator_paths_t& paths,
+                                   osr::node_idx_t const n,
                                    n::location_idx_t const a,
                                    n::location_idx_t const b) {
     if (n != osr::node_idx_t::invalid() &&
         w.r_->node_properties_[n].is_elevator()) {
-      auto l = std::unique_lock{elevator_in_paths_mutex};
-      elevator_in_paths[n].emplace(a, b);
+      paths.push_back({n, a, b});
     }
   };
 
-  auto const foot_candidates =
-      lookup_locations(w, lookup, pl, tt, matches, osr::search_profile::kFoot);
-  auto const wheelchair_candidates = lookup_locations(
-      w, lookup, pl, tt, matches, osr::search_profile::kWheelchair);
-
-  auto m = std::mutex{};
   for (auto const mode :
        {osr::search_profile::kFoot, osr::search_profile::kWheelchair}) {
+    auto const profile = mode == osr::search_profile::kFoot ? 0U : 1U;
+    auto const progress_offset = profile * locations.size();
     auto const& candidates = mode == osr::search_profile::kFoot
                                  ? foot_candidates
                                  : wheelchair_candidates;
-    utl::parallel_for_run(tt.n_locations(), [&](auto const i) {
-      auto const l = n::location_idx_t{i};
-      auto& footpaths =
-          (mode == osr::search_profile::kFoot ? footpaths_out_foot[l]
-                                              : footpaths_out_wheelchair[l]);
-      auto neighbors = std::vector<n::location_idx_t>{};
-      loc_rtree.in_radius(tt.locations_.coordinates_[l], kMaxDistance,
-                          [&](n::location_idx_t const x) {
-                            if (x != l) {
-                              neighbors.emplace_back(x);
-                            }
-                          });
-      auto const results = osr::route(
-          w, mode, get_loc(tt, w, pl, matches, l),
-          utl::to_vec(neighbors,
-                      [&](auto&& x) { return get_loc(tt, w, pl, matches, x); }),
-          candidates[l],
-          utl::to_vec(neighbors, [&](auto&& x) { return candidates[x]; }),
-          kMaxDuration, osr::direction::kForward, nullptr,
-          [](osr::path const& p) { return p.uses_elevator_; });
-      for (auto const [n, r] : utl::zip(neighbors, results)) {
-        if (r.has_value()) {
-          auto lock = std::scoped_lock{m};
-          auto const duration = n::duration_t{r->cost_ / 60U};
-          if (duration < n::footpath::kMaxDuration) {
-            footpaths.emplace_back(n::footpath{n, duration});
-          }
-          for (auto const& s : r->segments_) {
-            add_if_elevator(s.from_, l, n);
-            add_if_elevator(s.from_, n, l);
-          }
+    auto& out = mode == osr::search_profile::kFoot ? footpaths_out_foot
+                                                   : footpaths_out_wheelchair;
+    for (auto from = 0U; from < locations.size(); from += kCheckpointRange) {
+      auto const to = std::min(from + kCheckpointRange,
+                               static_cast<unsigned>(locations.size()));
+      auto todo = std::vector<n::location_idx_t>{};
+      for (auto i = from; i != to; ++i) {
+        if (!done[profile][to_idx(locations[i])]) {
+          todo.push_back(locations[i]);
         }
       }
+      if (todo.empty()) {
+        pt->update_monotonic(progress_offset + to);
+        continue;
+      }
 
-      utl::sort(footpaths_out_foot[l]);
-      utl::sort(footpaths_out_wheelchair[l]);
+      // Routing time grows with the number of neighbors.
+      auto todo_neighbors = std::vector<std::vector<n::location_idx_t>>{};
+      todo_neighbors.resize(todo.size());
+      utl::parallel_for_run(todo.size(), [&](auto const j) {
+        todo_neighbors[j] = get_neighbors(todo[j]);
+      });
 
-      pt->update_monotonic(
-          (mode == osr::search_profile::kFoot ? 0U : tt.n_locations()) + i);
-    });
-  }
+      // Every location has its own output, no locking required.
+      auto todo_elevator_paths = std::vector<elevator_paths_t>{};
+      todo_elevator_paths.resize(todo.size());
+      auto const costs = utl::to_vec(todo_neighbors, [](auto&& x) {
+        return static_cast<std::uint32_t>(x.size());
+      });
+      auto n_done = std::atomic_size_t{0U};
+      parallel_for_by_cost(costs, [&](std::size_t const j) {
+        auto const l = todo[j];
+        auto const& neighbors = todo_neighbors[j];
+        auto& footpaths = out[l];
+        auto& elevator_paths = todo_elevator_paths[j];
+        auto const results = osr::route(
+            w, mode, positions[l],
+            utl::to_vec(neighbors, [&](auto&& x) { return positions[x]; }),
+            candidates[l],
+            utl::to_vec(neighbors, [&](auto&& x) { return candidates[x]; }),
+            kMaxDuration, osr::direction::kForward, nullptr,
+            [](osr::path const& p) { return p.uses_elevator_; });
+        for (auto const [n, r] : utl::zip(neighbors, results)) {
+          if (r.has_value()) {
+            auto const duration = n::duration_t{r->cost_ / 60U};
+            if (duration < n::footpath::kMaxDuration) {
+              footpaths.emplace_back(n::footpath{n, duration});
+            }
+            for (auto const& s : r->segments_) {
+              add_if_elevator(elevator_paths, s.from_, l, n);
+              add_if_elevator(elevator_paths, s.from_, n, l);
+            }
+          }
+        }
 
-  fmt::println(std::clog, "  -> create ingoing footpaths");
-  auto footpaths_in_foot =
-      n::vector_map<n::location_idx_t, std::vector<n::footpath>>{};
-  footpaths_in_foot.resize(tt.n_locations());
-  for (auto const [i, out] : utl::enumerate(footpaths_out_foot)) {
-    auto const l = n::location_idx_t{i};
-    for (auto const fp : out) {
-      assert(fp.target() < tt.n_locations());
-      footpaths_in_foot[fp.target()].emplace_back(
-          n::footpath{l, fp.duration()});
-    }
-  }
+        utl::sort(footpaths);
+
+        pt->update_monotonic(progress_offset + from + ++n_done);
+      });
 
-  auto footpaths_in_wheelchair =
-      n::vector_map<n::location_idx_t, std::vector<n::footpath>>{};
-  footpaths_in_wheelchair.resize(tt.n_locations());
-  for (auto const [i, out] : utl::enumerate(footpaths_out_wheelchair)) {
-    auto const l = n::location_idx_t{i};
-    for (auto const fp : out) {
-      assert(fp.target() < tt.n_locations());
-      footpaths_in_wheelchair[fp.target()].emplace_back(
-          n::footpath{l, fp.duration()});
+      auto elevator_paths = elevator_paths_t{};
+      for (auto const& paths : todo_elevator_paths) {
+        for (auto const& e : paths) {
+          elevator_in_paths[e.node_].emplace(e.from_, e.to_);
+        }
+        elevator_paths.insert(end(elevator_paths), begin(paths), end(paths));
+      }
+      if (checkpoint.has_value()) {
+        checkpoint->add(profile, todo, out, elevator_paths);
+      }
     }
   }
 
-  fmt::println(std::clog, "  -> copy footpaths");
-  for (auto const& x : footpaths_out_foot) {
-    tt.locations_.footpaths_out_[1].emplace_back(x);
-  }
-  for (auto const& x : footpaths_in_foot) {
-    tt.locations_.footpaths_in_[1].emplace_back(x);
-  }
-  for (auto const& x : footpaths_out_wheelchair) {
-    tt.locations_.footpaths_out_[2].emplace_back(x);
-  }
-  for (auto const& x : footpaths_in_wheelchair) {
-    tt.locations_.footpaths_in_[2].emplace_back(x);
+  if (opt.locations_.has_value()) {
+    return elevator_in_paths;
   }
 
+  fmt::println(std::clog, "  -> writing footpaths");
+  write_footpaths(footpaths_out_foot, tt.locations_.footpaths_out_[1],
+                  tt.locations_.footpaths_in_[1]);
+  write_footpaths(footpaths_out_wheelchair, tt.locations_.footpaths_out_[2],
+                  tt.locations_.footpaths_in_[2]);
+
   return elevator_in_paths;
 }
 
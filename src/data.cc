@@ -22,10 +22,13 @@
 #include "motis/config.h"
 #include "motis/constants.h"
 #include "motis/elevators/parse_fasta.h"
+#include "motis/itinerary_watch.h"
 #include "motis/match_platforms.h"
 #include "motis/point_rtree.h"
+#include "motis/shapes.h"
 #include "motis/tag_lookup.h"
 #include "motis/tiles_data.h"
+#include "motis/trip_id_index.h"
 #include "motis/tt_location_rtree.h"
 #include "motis/update_rtt_td_footpaths.h"
 
@@ -49,9 +52,11 @@ std::ostream& operator<<(std::ostream& out, data const& d) {
              << "\nmatches=" << d.matches_ << "\nrt=" << d.rt_ << "\n";
 }
 
-data::data(std::filesystem::path p) : path_{std::move(p)} {}
+data::data(std::filesystem::path p)
+    : path_{std::move(p)}, watch_{std::make_unique<itinerary_watch>()} {}
 
-data::data(std::filesystem::path p, config const& c) : path_{std::move(p)} {
+data::data(std::filesystem::path p, config const& c)
+    : path_{std::move(p)}, watch_{std::make_unique<itinerary_watch>()} {
   rt_ = std::make_shared<rt>();
 
   auto const geocoder = std::async(std::launch::async, [&]() {
@@ -66,6 +71,9 @@ data::data(std::filesystem::path p, config const& c) : path_{std::move(p)} {
   auto const tt = std::async(std::launch::async, [&]() {
     if (c.timetable_) {
       load_tt();
+      if (c.timetable_->with_shapes_) {
+        load_shapes();
+      }
     }
   });
 
@@ -123,6 +131,7 @@ void data::load_tt() {
   tags_ = tag_lookup::read(path_ / "tags.bin");
   tt_ = n::timetable::read(path_ / "tt.bin");
   tt_->locations_.resolve_timezones();
+  trip_ids_ = std::make_unique<trip_id_index>(*tt_);
   location_rtee_ = std::make_unique<point_rtree<n::location_idx_t>>(
       create_location_rtree(*tt_));
 
@@ -132,6 +141,11 @@ void data::load_tt() {
       n::rt::create_rt_timetable(*tt_, today));
 }
 
+void data::load_shapes() {
+  shapes_ = std::make_unique<shapes>(path_ / "shapes",
+                                     cista::mmap::protection::READ);
+}
+
 void data::load_geocoder() {
   t_ = adr::read(path_ / "adr" / "t.bin");
   tc_ = std::make_unique<adr::cache>(t_->strings_.size(), 100U);
@@ -145,6 +159,11 @@ void data::load_reverse_geocoder() {
 
 void data::load_matches() {
   matches_ = cista::read<platform_matches_t>(path_ / "matches.bin");
+  positions_ = cista::read<location_positions_t>(path_ / "positions.bin");
+  platform_centers_ =
+      cista::read<platform_centers_t>(path_ / "platform_centers.bin");
+  route_names_ =
+      cista::read<location_route_names_t>(path_ / "route_names.bin");
 }
 
 void data::load_elevators() {
@@ -153,8 +172,8 @@ void data::load_elevators() {
 
   auto const elevator_footpath_map =
       cista::read<elevator_footpath_map_t>(path_ / "elevator_footpath_map.bin");
-  update_rtt_td_footpaths(*w_, *l_, *pl_, *tt_, *location_rtee_, *rt_->e_,
-                          *elevator_footpath_map, *matches_, *rt_->rtt_,
+  update_rtt_td_footpaths(*w_, *l_, *tt_, *location_rtee_, *rt_->e_,
+                          *elevator_footpath_map, *positions_, *rt_->rtt_,
                           std::chrono::seconds{kMaxDuration});
 }
 
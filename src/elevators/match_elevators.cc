@@ -9,11 +9,12 @@ namespace motis {
 
 point_rtree<elevator_idx_t> create_elevator_rtree(
     nigiri::vector_map<elevator_idx_t, elevator> const& elevators) {
-  auto t = point_rtree<elevator_idx_t>{};
+  auto entries = std::vector<point_rtree<elevator_idx_t>::entry>{};
+  entries.reserve(elevators.size());
   for (auto const [i, e] : utl::enumerate(elevators)) {
-    t.add(e.pos_, elevator_idx_t{i});
+    entries.push_back({e.pos_, elevator_idx_t{i}});
   }
-  return t;
+  return point_rtree<elevator_idx_t>{std::move(entries)};
 }
 
 osr::hash_set<osr::node_idx_t> get_elevator_nodes(osr::ways const& w) {
@@ -30,20 +31,11 @@ osr::hash_set<osr::node_idx_t> get_elevator_nodes(osr::ways const& w) {
 
 elevator_idx_t match_elevator(
     point_rtree<elevator_idx_t> const& rtree,
-    nigiri::vector_map<elevator_idx_t, elevator> const& elevators,
+    nigiri::vector_map<elevator_idx_t, elevator> const&,
     osr::ways const& w,
     osr::node_idx_t const n) {
   auto const pos = w.get_node_pos(n).as_latlng();
-  auto closest = elevator_idx_t::invalid();
-  auto closest_dist = std::numeric_limits<double>::max();
-  rtree.find(pos, [&](elevator_idx_t const e) {
-    auto const dist = geo::distance(elevators[e].pos_, pos);
-    if (dist < 20 && dist < closest_dist) {
-      closest_dist = dist;
-      closest = e;
-    }
-  });
-  return closest;
+  return rtree.nearest(pos, 20.0).value_or(elevator_idx_t::invalid());
 }
 
 osr::bitvec<osr::node_idx_t> get_blocked_elevators(
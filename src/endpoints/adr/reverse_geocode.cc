@@ -12,7 +12,7 @@ api::reverseGeocode_response reverse_geocode::operator()(
     boost::urls::url_view const& url) const {
   auto const params = api::reverseGeocode_params{url.params()};
   return suggestions_to_response(
-      t_, tt_, tags_, {}, {},
+      t_, tags_, {}, {},
       r_.lookup(t_, parse_location((params.place_))->pos_, 5U));
 }
 
@@ -31,7 +31,6 @@ long get_area_lang_idx(a::typeahead const& t,
 
 api::geocode_response suggestions_to_response(
     adr::typeahead const& t,
-    n::timetable const& tt,
     tag_lookup const& tags,
     std::basic_string<a::language_idx_t> const& lang_indices,
     std::vector<adr::token> const& token_pos,
@@ -70,7 +69,8 @@ api::geocode_response suggestions_to_response(
                          : api::typeEnum::PLACE;
               id =
                   type == api::typeEnum::STOP
-                      ? tags.id(tt, n::location_idx_t{t.place_osm_ids_[p]})
+                      ? std::string{tags.id(
+                            n::location_idx_t{t.place_osm_ids_[p]})}
                       : fmt::format("{}/{}",
                                     t.place_is_way_[to_idx(p)] ? "way" : "node",
                                     t.place_osm_ids_[p]);
@@ -8,9 +8,9 @@
 #include "utl/pipes/vec.h"
 
 #include "motis/constants.h"
+#include "motis/data.h"
 #include "motis/elevators/elevators.h"
 #include "motis/elevators/match_elevator.h"
-#include "motis/get_loc.h"
 #include "motis/match_platforms.h"
 
 namespace json = boost::json;
@@ -37,14 +37,12 @@ api::footpaths_response footpaths::operator()(
     footpaths[fp.target()].default_ = fp.duration().count();
   }
 
-  auto const loc = get_loc(tt_, w_, pl_, matches_, l.l_);
+  auto const& loc = positions_[l.l_];
   for (auto const mode :
        {osr::search_profile::kFoot, osr::search_profile::kWheelchair}) {
     auto const results = osr::route(
         w_, l_, mode, loc,
-        utl::to_vec(
-            neighbors,
-            [&](auto&& l) { return get_loc(tt_, w_, pl_, matches_, l); }),
+        utl::to_vec(neighbors, [&](auto&& l) { return positions_[l]; }),
         kMaxDuration, osr::direction::kForward, kMaxMatchingDistance,
         e == nullptr ? nullptr : &e->blocked_,
         [](osr::path const& p) { return p.uses_elevator_; });
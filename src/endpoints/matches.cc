@@ -1,8 +1,15 @@
 #include "motis/endpoints/matches.h"
 
-#include "osr/geojson.h"
+#include <sstream>
 
-#include "motis/location_routes.h"
+#include "utl/overloaded.h"
+
+#include "nigiri/timetable.h"
+
+#include "osr/platforms.h"
+#include "osr/ways.h"
+
+#include "motis/json_writer.h"
 #include "motis/match_platforms.h"
 
 namespace json = boost::json;
@@ -10,6 +17,12 @@ namespace n = nigiri;
 
 namespace motis::ep {
 
+constexpr auto const kMaxFeatures = 10'000U;
+
+// Platforms get at most half of the features so that locations and their
+// matches are shown in dense areas, too. Locations get the rest.
+constexpr auto const kMaxPlatformFeatures = kMaxFeatures / 2U;
+
 std::string get_names(osr::platforms const& pl, osr::platform_idx_t const x) {
   auto ss = std::stringstream{};
   for (auto const y : pl.platform_names_[x]) {
@@ -18,79 +31,125 @@ std::string get_names(osr::platforms const& pl, osr::platform_idx_t const x) {
   return ss.str();
 }
 
-json::value matches::operator()(json::value const& query) const {
+void write_coordinates(json_writer& w, geo::latlng const& pos) {
+  w.begin_array();
+  w.value(pos.lng_);
+  w.value(pos.lat_);
+  w.end_array();
+}
+
+void write_point(json_writer& w, geo::latlng const& pos) {
+  w.begin_object();
+  w.member("type", "Point");
+  w.key("coordinates");
+  write_coordinates(w, pos);
+  w.end_object();
+}
+
+void write_line(json_writer& w, geo::latlng const& a, geo::latlng const& b) {
+  w.begin_object();
+  w.member("type", "LineString");
+  w.key("coordinates");
+  w.begin_array();
+  write_coordinates(w, a);
+  write_coordinates(w, b);
+  w.end_array();
+  w.end_object();
+}
+
+void matches::write_json(json::value const& query, std::string& out) const {
   auto const& q = query.as_array();
 
   auto const min = geo::latlng{q[1].as_double(), q[0].as_double()};
   auto const max = geo::latlng{q[3].as_double(), q[2].as_double()};
 
-  auto matches = json::array{};
+  auto w = json_writer{out};
+  auto n_features = 0U;
+  auto truncated = false;
+  auto const begin_feature = [&](std::string_view type) {
+    ++n_features;
+    w.begin_object();
+    w.member("type", "Feature");
+    w.key("properties");
+    w.begin_object();
+    w.member("type", type);
+  };
+  auto const end_feature = [&]() { w.end_object(); };
+
+  w.begin_object();
+  w.member("type", "FeatureCollection");
+  w.key("features");
+  w.begin_array();
 
   pl_.find(min, max, [&](osr::platform_idx_t const p) {
-    auto const center = get_platform_center(pl_, w_, p);
-    if (!center.has_value()) {
+    if (n_features >= kMaxPlatformFeatures) {
+      truncated = true;
       return;
     }
-    matches.emplace_back(json::value{
-        {"type", "Feature"},
-        {"properties",
-         {{"type", "platform"},
-          {"level", to_float(pl_.get_level(w_, p))},
-          {"platform_names", fmt::format("{}", get_names(pl_, p))}}},
-        {"geometry", osr::to_point(osr::point::from_latlng(*center))}});
+    begin_feature("platform");
+    w.member("level", to_float(pl_.get_level(w_, p)));
+    w.member("platform_names", get_names(pl_, p));
+    w.end_object();
+    w.key("geometry");
+    write_point(w, platform_centers_[p]);
+    end_feature();
   });
 
   loc_rtree_.find({min, max}, [&](n::location_idx_t const l) {
+    if (n_features + 2U > kMaxFeatures) {  // location + match
+      truncated = true;
+      return;
+    }
+
     auto const pos = tt_.locations_.coordinates_[l];
-    auto const match = get_match(tt_, pl_, w_, l);
-    auto props =
-        json::value{{"name", tt_.locations_.names_[l].view()},
-                    {"id", tt_.locations_.ids_[l].view()},
-                    {"src", to_idx(tt_.locations_.src_[l])},
-                    {"type", "location"},
-                    {"trips", fmt::format("{}", get_location_routes(tt_, l))}}
-            .as_object();
-    if (match == osr::platform_idx_t::invalid()) {
-      props.emplace("level", "-");
-    } else {
+    auto const match = matches_[l];
+    auto const write_properties = [&]() {
+      w.member("name", tt_.locations_.names_[l].view());
+      w.member("id", tt_.locations_.ids_[l].view());
+      w.member("src", to_idx(tt_.locations_.src_[l]));
+      w.member("trips", route_names_[l].view());
+      if (match == osr::platform_idx_t::invalid()) {
+        w.member("level", "-");
+        return;
+      }
       std::visit(
           utl::overloaded{
               [&](osr::way_idx_t x) {
-                props.emplace("osm_way_id", to_idx(w_.way_osm_idx_[x]));
-                props.emplace("level",
-                              to_float(w_.r_->way_properties_[x].from_level()));
+                w.member("osm_way_id", to_idx(w_.way_osm_idx_[x]));
+                w.member("level",
+                         to_float(w_.r_->way_properties_[x].from_level()));
               },
               [&](osr::node_idx_t x) {
-                props.emplace("osm_node_id", to_idx(w_.node_to_osm_[x]));
-                props.emplace(
-                    "level", to_float(w_.r_->node_properties_[x].from_level()));
+                w.member("osm_node_id", to_idx(w_.node_to_osm_[x]));
+                w.member("level",
+                         to_float(w_.r_->node_properties_[x].from_level()));
               }},
           osr::to_ref(pl_.platform_ref_[match][0]));
-    }
-    matches.emplace_back(
-        json::value{{"type", "Feature"},
-                    {"properties", props},
-                    {"geometry", osr::to_point(osr::point::from_latlng(pos))}});
+    };
 
-    if (match == osr::platform_idx_t::invalid()) {
-      return;
-    }
-
-    props.emplace("platform_names", fmt::format("{}", get_names(pl_, match)));
+    begin_feature("location");
+    write_properties();
+    w.end_object();
+    w.key("geometry");
+    write_point(w, pos);
+    end_feature();
 
-    auto const center = get_platform_center(pl_, w_, match);
-    if (!center.has_value()) {
+    if (match == osr::platform_idx_t::invalid()) {
       return;
     }
 
-    props.insert_or_assign("type", "match");
-    matches.emplace_back(json::value{
-        {"type", "Feature"},
-        {"properties", props},
-        {"geometry", osr::to_line_string({osr::point::from_latlng(*center),
-                                          osr::point::from_latlng(pos)})}});
+    begin_feature("match");
+    write_properties();
+    w.member("platform_names", get_names(pl_, match));
+    w.end_object();
+    w.key("geometry");
+    write_line(w, platform_centers_[match], pos);
+    end_feature();
   });
-  return json::value{{"type", "FeatureCollection"}, {"features", matches}};
+
+  w.end_array();
+  w.member("truncated", truncated);
+  w.end_object();
 }
 
 }  // namespace motis::ep
\ No newline at end of file
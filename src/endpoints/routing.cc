@@ -18,6 +18,8 @@
 #include "motis/journey_to_response.h"
 #include "motis/max_distance.h"
 #include "motis/parse_location.h"
+#include "motis/polyline.h"
+#include "motis/request_arena.h"
 #include "motis/tag_lookup.h"
 #include "motis/time_conv.h"
 #include "motis/update_rtt_td_footpaths.h"
@@ -91,7 +93,7 @@ td_offsets_t routing::get_td_offsets(elevators const& e,
     }
 
     utl::equal_ranges_linear(
-        get_td_footpaths(w_, l_, pl_, tt_, loc_tree_, e, matches_,
+        get_td_footpaths(w_, l_, loc_tree_, e, positions_,
                          n::location_idx_t::invalid(), pos, dir, profile, max,
                          *blocked),
         [](n::td_footpath const& a, n::td_footpath const& b) {
@@ -259,6 +261,7 @@ api::plan_response routing::operator()(boost::urls::url_view const& url) const {
   }
 
   auto const query = api::plan_params{url.params()};
+  auto arena = request_arena{};
   auto const from = get_place(tt_, tags_, query.fromPlace_);
   auto const to = get_place(tt_, tags_, query.toPlace_);
   auto const from_modes = get_from_modes(query.mode_);
@@ -353,19 +356,27 @@ api::plan_response routing::operator()(boost::urls::url_view const& url) const {
       query.arriveBy_ ? n::direction::kBackward : n::direction::kForward,
       std::nullopt);
 
+  auto places = query.compactPlaces_ ? std::optional{place_table{}}
+                                     : std::nullopt;
+  auto itineraries = utl::to_vec(
+      *r.journeys_,
+      [&, cache = street_routing_cache_t{arena.get()}](auto&& j) mutable {
+        return journey_to_response(
+            w_, l_, tt_, tags_, pl_, e, rtt, matches_, shapes_.get(),
+            query.wheelchair_, query.debug_, query.geometryTolerance_,
+            to_polyline_precision(query.geometryPrecision_), j, start, dest,
+            places.has_value() ? &*places : nullptr, cache, *blocked);
+      });
+
   return {
       .from_ = to_place(tt_, tags_, from, "Origin"),
       .to_ = to_place(tt_, tags_, to, "Destination"),
-      .itineraries_ =
-          utl::to_vec(*r.journeys_,
-                      [&, cache = street_routing_cache_t{}](auto&& j) mutable {
-                        return journey_to_response(
-                            w_, l_, tt_, tags_, pl_, e, rtt, matches_,
-                            query.wheelchair_, j, start, dest, cache, *blocked);
-                      }),
+      .itineraries_ = std::move(itineraries),
       .previousPageCursor_ =
           fmt::format("EARLIER|{}", to_seconds(r.interval_.from_)),
       .nextPageCursor_ = fmt::format("LATER|{}", to_seconds(r.interval_.to_)),
+      .places_ = places.has_value() ? std::optional{std::move(places->places_)}
+                                    : std::nullopt,
   };
 }
 
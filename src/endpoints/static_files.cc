@@ -0,0 +1,166 @@
+#include "motis/endpoints/static_files.h"
+
+#include <fstream>
+#include <optional>
+#include <thread>
+
+#include "fmt/format.h"
+
+#include "cista/hashing.h"
+
+#include "utl/read_file.h"
+
+#include "net/web_server/url_decode.h"
+
+#include "motis/compression.h"
+
+namespace fs = std::filesystem;
+namespace http = boost::beast::http;
+
+namespace motis::ep {
+
+std::string_view get_content_type(fs::path const& p) {
+  auto const ext = p.extension().generic_string();
+  if (ext == ".html") {
+    return "text/html; charset=utf-8";
+  } else if (ext == ".js" || ext == ".mjs") {
+    return "text/javascript";
+  } else if (ext == ".css") {
+    return "text/css";
+  } else if (ext == ".json" || ext == ".map") {
+    return "application/json";
+  } else if (ext == ".svg") {
+    return "image/svg+xml";
+  } else if (ext == ".wasm") {
+    return "application/wasm";
+  } else if (ext == ".txt") {
+    return "text/plain; charset=utf-8";
+  }
+  return "application/octet-stream";
+}
+
+// File to serve for the request path, nullopt if outside of root or missing.
+std::optional<fs::path> resolve(fs::path const& root, std::string const& path) {
+  auto const rel = fs::path{path}.relative_path().lexically_normal();
+  if (rel.empty() || *rel.begin() == "..") {
+    return std::nullopt;
+  }
+
+  auto p = root / rel;
+  if (fs::is_directory(p)) {
+    p /= "index.html";
+  }
+  if (!fs::is_regular_file(p)) {
+    return std::nullopt;
+  }
+  return p;
+}
+
+// Gzip version of `p` in `gzip_dir`, written on first access. Its name
+// depends on the modification time and size of `p`, so changed files get
+// a new one. Concurrent writers of the same file each rename a complete
+// temporary file, readers never see a partial one.
+std::optional<fs::path> get_gzip(fs::path const& gzip_dir,
+                                 fs::path const& p,
+                                 std::uintmax_t const size) {
+  auto ec = std::error_code{};
+  auto const mtime = fs::last_write_time(p, ec);
+  if (ec) {
+    return std::nullopt;
+  }
+
+  auto const name = fmt::format(
+      "{:016x}.gz",
+      cista::build_hash(p.generic_string(), mtime.time_since_epoch().count(),
+                        size));
+  auto const gz = gzip_dir / name;
+  if (fs::exists(gz, ec)) {
+    return gz;
+  }
+
+  auto const content = utl::read_file(p.generic_string().c_str());
+  if (!content.has_value()) {
+    return std::nullopt;
+  }
+
+  auto const tmp = gzip_dir / fmt::format(
+                                  "{}.{}.tmp", name,
+                                  std::hash<std::thread::id>{}(
+                                      std::this_thread::get_id()));
+  {
+    auto out = std::ofstream{tmp, std::ios::binary};
+    out << gzip(*content);
+    if (!out) {
+      return std::nullopt;
+    }
+  }
+  fs::rename(tmp, gz, ec);
+  if (ec) {
+    fs::remove(tmp, ec);
+    return std::nullopt;
+  }
+  return gz;
+}
+
+net::reply not_found(net::route_request const& req) {
+  auto res =
+      net::web_server::string_res_t{http::status::not_found, req.version()};
+  res.body() = "not found";
+  res.keep_alive(req.keep_alive());
+  return res;
+}
+
+static_files::static_files(fs::path root, fs::path gzip_dir)
+    : root_{std::move(root)}, gzip_dir_{std::move(gzip_dir)} {
+  auto ec = std::error_code{};
+  fs::remove_all(gzip_dir_, ec);
+  fs::create_directories(gzip_dir_);
+}
+
+net::reply static_files::operator()(net::route_request const& req,
+                                    bool) const {
+  auto path = std::string{};
+  net::url_decode(req.url_.path(), path);
+  if (path.empty() || path.back() == '/') {
+    path += "index.html";
+  }
+
+  auto const p = resolve(root_, path);
+  auto ec = std::error_code{};
+  auto const size = p.has_value() ? fs::file_size(*p, ec) : 0U;
+  if (!p.has_value() || ec) {
+    return not_found(req);
+  }
+
+  auto const compress = size >= kMinCompressSize;
+  auto const gz =
+      compress &&
+              accepts_gzip(std::string_view{req[http::field::accept_encoding]})
+          ? get_gzip(gzip_dir_, *p, size)
+          : std::nullopt;
+
+  auto body = http::file_body::value_type{};
+  auto body_ec = boost::beast::error_code{};
+  body.open(gz.value_or(*p).generic_string().c_str(),
+            boost::beast::file_mode::scan, body_ec);
+  if (body_ec) {
+    return not_found(req);
+  }
+
+  auto const body_size = body.size();
+  auto res = net::web_server::file_res_t{
+      std::piecewise_construct, std::make_tuple(std::move(body)),
+      std::make_tuple(http::status::ok, req.version())};
+  res.insert(http::field::content_type, get_content_type(*p));
+  if (compress) {
+    res.insert(http::field::vary, "Accept-Encoding");
+  }
+  if (gz.has_value()) {
+    res.insert(http::field::content_encoding, "gzip");
+  }
+  res.content_length(body_size);
+  res.keep_alive(req.keep_alive());
+  return res;
+}
+
+}  // namespace motis::ep
\ No newline at end of file
@@ -266,41 +266,71 @@ std::vector<n::rt::run> get_events(
   return evs;
 }
 
-api::stoptimes_response stop_times::operator()(
-    boost::urls::url_view const& url) const {
-  auto const query = api::stoptimes_params{url.params()};
+struct stop_events {
+  std::shared_ptr<rt> rt_;
+  n::event_type ev_type_;
+  std::vector<n::rt::run> events_;
+};
 
-  auto const x = tags_.get(tt_, query.stopId_);
-  auto const p = tt_.locations_.parents_[x];
+stop_events get_stop_events(n::timetable const& tt,
+                            tag_lookup const& tags,
+                            std::shared_ptr<rt> const& rt,
+                            api::stoptimes_params const& query) {
+  auto const x = tags.get(tt, query.stopId_);
+  auto const p = tt.locations_.parents_[x];
   auto const l = p == n::location_idx_t::invalid() ? x : p;
-  auto const l_name = tt_.locations_.names_[l].view();
+  auto const l_name = tt.locations_.names_[l].view();
   auto const [dir, time] = parse_cursor(query.pageCursor_.value_or(
       fmt::format("{}|{}", query.arriveBy_ ? "EARLIER" : "LATER",
                   to_seconds(get_date_time(query.date_, query.time_)))));
 
   auto locations = std::vector{l};
-  utl::concat(locations, tt_.locations_.children_[l]);
-  for (auto const eq : tt_.locations_.equivalences_[l]) {
-    if (tt_.locations_.names_[eq].view() == l_name) {
+  utl::concat(locations, tt.locations_.children_[l]);
+  for (auto const eq : tt.locations_.equivalences_[l]) {
+    if (tt.locations_.names_[eq].view() == l_name) {
       locations.emplace_back(eq);
     }
   }
   utl::erase_duplicates(locations);
 
-  auto const rt = rt_;
-  auto const rtt = rt->rtt_.get();
-  auto const ev_type =
-      query.arriveBy_ ? n::event_type::kArr : n::event_type::kDep;
-  auto events = get_events(locations, tt_, rtt, time, ev_type, dir,
+  auto ret = stop_events{
+      .rt_ = rt,
+      .ev_type_ = query.arriveBy_ ? n::event_type::kArr : n::event_type::kDep};
+  auto const rtt = ret.rt_->rtt_.get();
+  ret.events_ = get_events(locations, tt, rtt, time, ret.ev_type_, dir,
                            static_cast<std::size_t>(query.n_));
-  utl::sort(events, [&](n::rt::run const& a, n::rt::run const& b) {
-    auto const fr_a = n::rt::frun{tt_, rtt, a};
-    auto const fr_b = n::rt::frun{tt_, rtt, b};
-    return fr_a[0].time(ev_type) < fr_b[0].time(ev_type);
+  utl::sort(ret.events_, [&](n::rt::run const& a, n::rt::run const& b) {
+    auto const fr_a = n::rt::frun{tt, rtt, a};
+    auto const fr_b = n::rt::frun{tt, rtt, b};
+    return fr_a[0].time(ret.ev_type_) < fr_b[0].time(ret.ev_type_);
   });
+  return ret;
+}
+
+std::pair<std::string, std::string> get_page_cursors(n::timetable const& tt,
+                                                     stop_events const& e) {
+  if (e.events_.empty()) {
+    return {};
+  }
+  auto const rtt = e.rt_->rtt_.get();
+  auto const first = n::rt::frun{tt, rtt, e.events_.front()}[0];
+  auto const last = n::rt::frun{tt, rtt, e.events_.back()}[0];
+  return {fmt::format("EARLIER|{}", to_seconds(first.time(e.ev_type_) -
+                                               std::chrono::minutes{1})),
+          fmt::format("LATER|{}", to_seconds(last.time(e.ev_type_) +
+                                             std::chrono::minutes{1}))};
+}
+
+api::stoptimes_response stop_times::operator()(
+    boost::urls::url_view const& url) const {
+  auto const query = api::stoptimes_params{url.params()};
+  auto const e = get_stop_events(tt_, tags_, rt_, query);
+  auto const rtt = e.rt_->rtt_.get();
+  auto const ev_type = e.ev_type_;
+  auto [prev_cursor, next_cursor] = get_page_cursors(tt_, e);
   return {
       .stopTimes_ = utl::to_vec(
-          events,
+          e.events_,
           [&](n::rt::run const r) -> api::StopTime {
             auto const fr = n::rt::frun{tt_, rtt, r};
             auto const s = fr[0];
@@ -319,29 +349,17 @@ api::stoptimes_response stop_times::operator()(
                 .routeTextColor_ =
                     to_str(s.get_route_color(ev_type).text_color_),
                 .routeId_ = "",
-                .tripId_ = tags_.id(tt_, s.get_trip_idx(ev_type)),
+                .tripId_ = std::string{tags_.id(s.get_trip_idx(ev_type))},
                 .serviceDate_ = fr.is_scheduled()
                                     ? get_service_date(tt_, fr.t_, s.stop_idx_)
                                     : "ADDED",
                 .routeShortName_ = std::string{s.trip_display_name(ev_type)},
-                .source_ = fmt::format("{}", fmt::streamed(fr.dbg()))};
+                .source_ = query.debug_ ? std::optional{fmt::format(
+                                              "{}", fmt::streamed(fr.dbg()))}
+                                        : std::nullopt};
           }),
-      .previousPageCursor_ =
-          events.empty()
-              ? ""
-              : fmt::format(
-                    "EARLIER|{}",
-                    to_seconds(
-                        n::rt::frun{tt_, rtt, events.front()}[0].time(ev_type) -
-                        std::chrono::minutes{1})),
-      .nextPageCursor_ =
-          events.empty()
-              ? ""
-              : fmt::format(
-                    "LATER|{}",
-                    to_seconds(
-                        n::rt::frun{tt_, rtt, events.back()}[0].time(ev_type) +
-                        std::chrono::minutes{1}))};
+      .previousPageCursor_ = std::move(prev_cursor),
+      .nextPageCursor_ = std::move(next_cursor)};
 }
 
 }  // namespace motis::ep
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "motis/endpoints/trip.h"
 
+#include "utl/verify.h"
+#include "utl/zip.h"
+
 #include "nigiri/routing/journey.h"
 #include "nigiri/rt/frun.h"
 #include "nigiri/timetable.h"
@@ -7,36 +10,23 @@
 #include "motis/data.h"
 #include "motis/journey_to_response.h"
 #include "motis/parse_location.h"
+#include "motis/polyline.h"
+#include "motis/request_arena.h"
 #include "motis/tag_lookup.h"
+#include "motis/trip_id_index.h"
 
 namespace n = nigiri;
 
 namespace motis::ep {
 
 n::rt::run resolve_run(n::timetable const& tt,
+                       trip_id_index const& trip_ids,
                        date::sys_days const day,
                        n::source_idx_t const src,
                        std::string_view trip_id) {
   auto const day_idx = static_cast<int>(to_idx(tt.day_idx(day)));
-
-  auto const lb = std::lower_bound(
-      begin(tt.trip_id_to_idx_), end(tt.trip_id_to_idx_), trip_id,
-      [&](n::pair<n::trip_id_idx_t, n::trip_idx_t> const& a,
-          n::string const& b) {
-        return std::tuple(tt.trip_id_src_[a.first],
-                          tt.trip_id_strings_[a.first].view()) <
-               std::tuple(src, std::string_view{b});
-      });
-
-  auto const id_matches = [src, trip_id = trip_id,
-                           &tt](n::trip_id_idx_t const t_id_idx) {
-    return tt.trip_id_src_[t_id_idx] == src &&
-           tt.trip_id_strings_[t_id_idx].view() == trip_id;
-  };
-
-  for (auto i = lb; i != end(tt.trip_id_to_idx_) && id_matches(i->first); ++i) {
-    for (auto const [t_idx, stop_range] :
-         tt.trip_transport_ranges_[i->second]) {
+  for (auto const& [_, trip_idx] : trip_ids.find(tt, src, trip_id)) {
+    for (auto const [t_idx, stop_range] : tt.trip_transport_ranges_[trip_idx]) {
       auto const day_offset =
           tt.event_mam(t_idx, stop_range.from_, n::event_type::kDep).days();
       auto const first_dep_day = day_idx - day_offset;
@@ -55,27 +45,33 @@ n::rt::run resolve_run(n::timetable const& tt,
   return {};
 }
 
-api::Itinerary trip::operator()(boost::urls::url_view const& url) const {
-  auto const rt = rt_;
-  auto const rtt = rt->rtt_.get();
-
-  auto const query = api::trip_params{url.params()};
-  auto const day = parse_iso_date(query.date_);
-  auto const [tag, id] = split_tag_id(query.tripId_);
-  auto const r = resolve_run(tt_, day, tags_.get_src(tag), id);
-
-  auto fr = n::rt::frun{tt_, rtt, r};
+api::Itinerary trip_to_response(osr::ways const& w,
+                                osr::lookup const& l,
+                                osr::platforms const& pl,
+                                n::timetable const& tt,
+                                tag_lookup const& tags,
+                                n::rt_timetable const* rtt,
+                                platform_matches_t const& matches,
+                                shapes const* shape_store,
+                                bool const debug,
+                                double const geometry_tolerance,
+                                unsigned const geometry_precision,
+                                n::rt::run const r,
+                                street_routing_cache_t& cache,
+                                osr::bitvec<osr::node_idx_t>& blocked) {
+  utl::verify(r.valid(), "trip not found");
+
+  auto fr = n::rt::frun{tt, rtt, r};
   fr.stop_range_.to_ = fr.size();
   fr.stop_range_.from_ = 0U;
   auto const from_l = fr[0];
   auto const to_l = fr[fr.size() - 1U];
   auto const start_time = from_l.time(n::event_type::kDep);
   auto const dest_time = to_l.time(n::event_type::kArr);
-  auto cache = street_routing_cache_t{};
-  auto blocked = osr::bitvec<osr::node_idx_t>{};
 
   return journey_to_response(
-      w_, l_, tt_, tags_, pl_, nullptr, rtt, matches_, false,
+      w, l, tt, tags, pl, nullptr, rtt, matches, shape_store, false, debug,
+      geometry_tolerance, geometry_precision,
       {.legs_ = {n::routing::journey::leg{
            n::direction::kForward, from_l.get_location_idx(),
            to_l.get_location_idx(), start_time, dest_time,
@@ -86,8 +82,64 @@ api::Itinerary trip::operator()(boost::urls::url_view const& url) const {
        .dest_time_ = dest_time,
        .dest_ = to_l.get_location_idx(),
        .transfers_ = 0U},
-      n::location_idx_t::invalid(), n::location_idx_t::invalid(), cache,
-      blocked);
+      n::location_idx_t::invalid(), n::location_idx_t::invalid(), nullptr,
+      cache, blocked);
+}
+
+api::Itinerary trip::operator()(boost::urls::url_view const& url) const {
+  auto const rt = rt_;
+  auto const rtt = rt->rtt_.get();
+
+  auto const query = api::trip_params{url.params()};
+  auto const day = parse_iso_date(query.date_);
+  auto const [tag, id] = split_tag_id(query.tripId_);
+  auto const r = resolve_run(tt_, trip_ids_, day, tags_.get_src(tag), id);
+
+  auto arena = request_arena{};
+  auto cache = street_routing_cache_t{arena.get()};
+  auto blocked = osr::bitvec<osr::node_idx_t>{};
+  return trip_to_response(w_, l_, pl_, tt_, tags_, rtt, matches_,
+                          shapes_.get(), query.debug_, query.geometryTolerance_,
+                          to_polyline_precision(query.geometryPrecision_), r,
+                          cache, blocked);
+}
+
+constexpr auto const kMaxTrips = 100U;
+
+api::trips_response trips::operator()(boost::urls::url_view const& url) const {
+  auto const rt = rt_;
+  auto const rtt = rt->rtt_.get();
+
+  auto const query = api::trips_params{url.params()};
+  utl::verify(query.tripId_.size() == query.date_.size(),
+              "tripId and date lists differ in length: {} vs {}",
+              query.tripId_.size(), query.date_.size());
+  utl::verify(query.tripId_.size() <= kMaxTrips,
+              "too many trips: {} (max. {})", query.tripId_.size(), kMaxTrips);
+
+  auto arena = request_arena{};
+  auto cache = street_routing_cache_t{arena.get()};
+  auto blocked = osr::bitvec<osr::node_idx_t>{};
+  auto first_idx = hash_map<n::transport, std::size_t>{};
+  auto response = api::trips_response{};
+  response.reserve(query.tripId_.size());
+  for (auto const [trip_id, date] : utl::zip(query.tripId_, query.date_)) {
+    auto const [tag, id] = split_tag_id(trip_id);
+    auto const r = resolve_run(tt_, trip_ids_, parse_iso_date(date),
+                               tags_.get_src(tag), id);
+    utl::verify(r.valid(), "trip not found: {} on {}", trip_id, date);
+
+    if (auto const it = first_idx.find(r.t_); it != end(first_idx)) {
+      response.emplace_back(response[it->second]);
+    } else {
+      first_idx.emplace(r.t_, response.size());
+      response.emplace_back(trip_to_response(
+          w_, l_, pl_, tt_, tags_, rtt, matches_, shapes_.get(), query.debug_,
+          query.geometryTolerance_,
+          to_polyline_precision(query.geometryPrecision_), r, cache, blocked));
+    }
+  }
+  return response;
 }
 
 }  // namespace motis::ep
\ No newline at end of file
@@ -5,7 +5,6 @@
 #include "motis/constants.h"
 #include "motis/elevators/elevators.h"
 #include "motis/elevators/parse_fasta.h"
-#include "motis/get_loc.h"
 #include "motis/update_rtt_td_footpaths.h"
 
 namespace json = boost::json;
@@ -44,7 +43,7 @@ json::value update_elevator::operator()(json::value const& query) const {
 
   auto new_e = elevators{w_, elevator_nodes_, std::move(elevators_copy)};
   auto new_rtt = n::rt::create_rt_timetable(tt_, rtt->base_day_);
-  update_rtt_td_footpaths(w_, l_, pl_, tt_, loc_rtree_, new_e, matches_, tasks,
+  update_rtt_td_footpaths(w_, l_, tt_, loc_rtree_, new_e, positions_, tasks,
                           rtt, new_rtt, std::chrono::seconds{kMaxDuration});
 
   rt_ = std::make_shared<rt>(
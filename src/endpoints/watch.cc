@@ -0,0 +1,96 @@
+#include "motis/endpoints/watch.h"
+
+#include "boost/json.hpp"
+
+#include "utl/helpers/algorithm.h"
+#include "utl/to_vec.h"
+#include "utl/verify.h"
+
+#include "nigiri/rt/frun.h"
+#include "nigiri/timetable.h"
+
+#include "motis/data.h"
+#include "motis/endpoints/trip.h"
+#include "motis/parse_location.h"
+#include "motis/tag_lookup.h"
+#include "motis/time_conv.h"
+
+namespace json = boost::json;
+namespace n = nigiri;
+
+namespace motis::ep {
+
+json::value to_json(n::timetable const& tt,
+                    tag_lookup const& tags,
+                    watch_id_t const id,
+                    itinerary_watch::itinerary const& x) {
+  auto legs = json::array{};
+  for (auto const& l : x.legs_) {
+    legs.emplace_back(json::value{
+        {"tripId", std::string{tags.id(
+                       n::rt::frun{tt, nullptr, l.r_}[l.enter_].get_trip_idx(
+                           n::event_type::kDep))}},
+        {"departure", to_ms(l.dep_)},
+        {"arrival", to_ms(l.arr_)},
+        {"departureDelay", to_ms(l.dep_delay_)},
+        {"arrivalDelay", to_ms(l.arr_delay_)},
+        {"realTime", l.is_rt_},
+        {"cancelled", l.cancelled_}});
+  }
+
+  auto transfers = json::array{};
+  for (auto const& t : x.transfers_) {
+    auto const min_duration = t.min_duration_.has_value()
+                                  ? json::value{to_seconds(*t.min_duration_)}
+                                  : json::value{};  // no footpath
+    transfers.emplace_back(
+        json::value{{"minDuration", min_duration},
+                    {"slack", to_seconds(t.slack_)},
+                    {"feasible", t.feasible_}});
+  }
+
+  return json::value{
+      {"id", to_idx(id)},
+      {"version", x.version_},
+      {"feasible", utl::all_of(x.transfers_,
+                               [](auto&& t) { return t.feasible_; }) &&
+                       utl::none_of(x.legs_,
+                                    [](auto&& l) { return l.cancelled_; })},
+      {"legs", std::move(legs)},
+      {"transfers", std::move(transfers)}};
+}
+
+json::value watch::operator()(json::value const& query) const {
+  auto const& q = query.as_object();
+
+  if (q.contains("legs")) {
+    auto const rt = rt_;
+    auto const legs =
+        utl::to_vec(q.at("legs").as_array(), [&](json::value const& x) {
+          auto const& leg = x.as_object();
+          auto const str = [&](char const* key) {
+            return std::string_view{leg.at(key).as_string()};
+          };
+          auto const [tag, trip_id] = split_tag_id(str("tripId"));
+          return itinerary_watch::leg_query{
+              .r_ = resolve_run(tt_, trip_ids_, parse_iso_date(str("date")),
+                                tags_.get_src(tag), trip_id),
+              .from_ = tags_.get(tt_, str("from")),
+              .to_ = tags_.get(tt_, str("to"))};
+        });
+    auto const id = watch_.add(tt_, rt->rtt_.get(), legs);
+    return to_json(tt_, tags_, id, *watch_.get(id));
+  }
+
+  auto const id = watch_id_t{q.at("id").to_number<std::uint32_t>()};
+  if (q.contains("remove") && q.at("remove").as_bool()) {
+    watch_.remove(id);
+    return json::value{{"id", to_idx(id)}, {"removed", true}};
+  }
+
+  auto const x = watch_.get(id);
+  utl::verify(x.has_value(), "watch {} not found", to_idx(id));
+  return to_json(tt_, tags_, id, *x);
+}
+
+}  // namespace motis::ep
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "motis/footpath_checkpoint.h"
+
+#include <cstring>
+#include <type_traits>
+
+#include "utl/verify.h"
+
+namespace fs = std::filesystem;
+namespace n = nigiri;
+
+namespace motis {
+
+constexpr auto const kHeaderSize = 2U * sizeof(std::uint64_t);
+constexpr auto const kCommittedOffset = sizeof(std::uint64_t);
+
+static_assert(std::is_trivially_copyable_v<n::footpath>);
+static_assert(std::is_trivially_copyable_v<footpath_checkpoint::elevator_path>);
+
+template <typename T>
+void write_at(cista::mmap& m, std::size_t const offset, T const& x) {
+  std::memcpy(m.data() + offset, &x, sizeof(T));
+}
+
+template <typename T>
+T read_at(cista::mmap const& m, std::size_t const offset) {
+  auto x = T{};
+  std::memcpy(&x, m.data() + offset, sizeof(T));
+  return x;
+}
+
+template <typename T>
+T read_next(cista::mmap const& m,
+            std::size_t& offset,
+            std::uint64_t const committed) {
+  utl::verify(offset + sizeof(T) <= committed, "broken footpath checkpoint");
+  auto const x = read_at<T>(m, offset);
+  offset += sizeof(T);
+  return x;
+}
+
+cista::mmap open_checkpoint(fs::path const& p) {
+  return cista::mmap{p.generic_string().c_str(),
+                     fs::is_regular_file(p) ? cista::mmap::protection::MODIFY
+                                            : cista::mmap::protection::WRITE};
+}
+
+bool has_key(cista::mmap const& m, cista::hash_t const key) {
+  return m.size() >= kHeaderSize && read_at<std::uint64_t>(m, 0U) == key &&
+         read_at<std::uint64_t>(m, kCommittedOffset) <= m.size();
+}
+
+std::vector<footpath_checkpoint::range> read_ranges(cista::mmap const& m) {
+  auto ranges = std::vector<footpath_checkpoint::range>{};
+  auto const committed = read_at<std::uint64_t>(m, kCommittedOffset);
+  auto offset = std::size_t{kHeaderSize};
+  auto const next_u32 = [&]() {
+    return read_next<std::uint32_t>(m, offset, committed);
+  };
+
+  while (offset != committed) {
+    auto& r = ranges.emplace_back();
+    r.profile_ = next_u32();
+    r.locations_.resize(next_u32());
+    r.footpaths_.resize(r.locations_.size());
+    r.elevator_paths_.resize(next_u32());
+    for (auto& l : r.locations_) {
+      l = n::location_idx_t{next_u32()};
+    }
+    for (auto& fps : r.footpaths_) {
+      fps.resize(next_u32());
+    }
+    for (auto& fps : r.footpaths_) {
+      for (auto& fp : fps) {
+        fp = read_next<n::footpath>(m, offset, committed);
+      }
+    }
+    for (auto& e : r.elevator_paths_) {
+      e = read_next<footpath_checkpoint::elevator_path>(m, offset, committed);
+    }
+  }
+
+  return ranges;
+}
+
+footpath_checkpoint::footpath_checkpoint(fs::path const& p,
+                                         cista::hash_t const key)
+    : mmap_{open_checkpoint(p)} {
+  if (has_key(mmap_, key)) {
+    return;
+  }
+  mmap_.resize(kHeaderSize);
+  write_at(mmap_, 0U, std::uint64_t{key});
+  write_at(mmap_, kCommittedOffset, std::uint64_t{kHeaderSize});
+  mmap_.sync();
+}
+
+std::vector<footpath_checkpoint::range> footpath_checkpoint::read() const {
+  return read_ranges(mmap_);
+}
+
+std::vector<footpath_checkpoint::range> footpath_checkpoint::read(
+    fs::path const& p, cista::hash_t const key) {
+  auto ec = std::error_code{};
+  if (!fs::is_regular_file(p, ec) || fs::file_size(p, ec) < kHeaderSize) {
+    return {};
+  }
+  auto const m = cista::mmap{p.generic_string().c_str(),
+                             cista::mmap::protection::READ};
+  return has_key(m, key) ? read_ranges(m) : std::vector<range>{};
+}
+
+void footpath_checkpoint::add(
+    std::uint32_t const profile,
+    std::span<n::location_idx_t const> locations,
+    n::vector_map<n::location_idx_t, std::vector<n::footpath>> const&
+        footpaths,
+    std::span<elevator_path const> elevator_paths) {
+  auto n_footpaths = std::size_t{0U};
+  for (auto const l : locations) {
+    n_footpaths += footpaths[l].size();
+  }
+
+  auto offset = read_at<std::uint64_t>(mmap_, kCommittedOffset);
+  mmap_.resize(offset + 3U * sizeof(std::uint32_t) +
+               2U * locations.size() * sizeof(std::uint32_t) +
+               n_footpaths * sizeof(n::footpath) +
+               elevator_paths.size() * sizeof(elevator_path));
+
+  auto const append = [&](auto const& x) {
+    write_at(mmap_, offset, x);
+    offset += sizeof(x);
+  };
+  append(profile);
+  append(static_cast<std::uint32_t>(locations.size()));
+  append(static_cast<std::uint32_t>(elevator_paths.size()));
+  for (auto const l : locations) {
+    append(to_idx(l));
+  }
+  for (auto const l : locations) {
+    append(static_cast<std::uint32_t>(footpaths[l].size()));
+  }
+  for (auto const l : locations) {
+    for (auto const& fp : footpaths[l]) {
+      append(fp);
+    }
+  }
+  for (auto const& e : elevator_paths) {
+    append(e);
+  }
+
+  // Data first, then the header pointing to it.
+  mmap_.sync();
+  write_at(mmap_, kCommittedOffset, std::uint64_t{offset});
+  mmap_.sync();
+}
+
+}  // namespace motis
\ No newline at end of file
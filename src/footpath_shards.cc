@@ -0,0 +1,227 @@
+#include "motis/footpath_shards.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#if defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+#include "utl/verify.h"
+
+#include "nigiri/timetable.h"
+
+#include "motis/compute_footpaths.h"
+#include "motis/data.h"
+#include "motis/footpath_checkpoint.h"
+#include "motis/point_rtree.h"
+
+namespace fs = std::filesystem;
+namespace n = nigiri;
+
+namespace motis {
+
+std::vector<std::vector<n::location_idx_t>> get_footpath_shards(
+    n::timetable const& tt, unsigned const n_shards) {
+  using rtree = point_rtree<n::location_idx_t>;
+
+  auto const& coordinates = tt.locations_.coordinates_;
+  auto extent = rtree::bbox::of(coordinates[n::location_idx_t{0U}]);
+  for (auto const& c : coordinates) {
+    extent.extend(rtree::bbox::of(c));
+  }
+
+  constexpr auto const kMax = double{(1U << 16U) - 1U};
+  auto const lat_range = std::max(extent.max_lat_ - extent.min_lat_, 1E-9);
+  auto const lng_range = std::max(extent.max_lng_ - extent.min_lng_, 1E-9);
+  auto order = std::vector<std::pair<std::uint32_t, n::location_idx_t>>{};
+  order.reserve(tt.n_locations());
+  for (auto l = n::location_idx_t{0U}; l != tt.n_locations(); ++l) {
+    auto const& p = coordinates[l];
+    order.emplace_back(
+        rtree::hilbert(
+            static_cast<std::uint32_t>(kMax * (p.lng_ - extent.min_lng_) /
+                                       lng_range),
+            static_cast<std::uint32_t>(kMax * (p.lat_ - extent.min_lat_) /
+                                       lat_range)),
+        l);
+  }
+  std::sort(begin(order), end(order));
+
+  auto shards = std::vector<std::vector<n::location_idx_t>>(n_shards);
+  for (auto i = 0U; i != order.size(); ++i) {
+    shards[std::size_t{i} * n_shards / order.size()].push_back(
+        order[i].second);
+  }
+  return shards;
+}
+
+fs::path get_footpath_shard_path(fs::path const& data_path,
+                                 unsigned const shard,
+                                 unsigned const n_shards) {
+  return data_path / "footpaths" /
+         fmt::format("shard-{}-of-{}.bin", shard, n_shards);
+}
+
+void compute_footpath_shard(fs::path const& data_path,
+                            unsigned const shard,
+                            unsigned const n_shards,
+                            cista::hash_t const key) {
+  utl::verify(shard < n_shards, "invalid shard {} of {}", shard, n_shards);
+
+  auto d = data{data_path};
+  d.load_tt();
+  d.load_osr();
+  d.load_matches();
+
+  auto shards = get_footpath_shards(*d.tt_, n_shards);
+  compute_footpaths(
+      *d.w_, *d.l_, *d.tt_, *d.platform_centers_, *d.matches_, *d.positions_,
+      {.checkpoint_ = get_footpath_shard_path(data_path, shard, n_shards),
+       .checkpoint_key_ = key,
+       .locations_ = std::move(shards[shard])});
+}
+
+bool is_complete(fs::path const& p,
+                 cista::hash_t const key,
+                 std::size_t const n_locations) {
+  auto n_results = std::size_t{0U};
+  for (auto const& r : footpath_checkpoint::read(p, key)) {
+    n_results += r.locations_.size();
+  }
+  return n_results == 2U * n_locations;  // foot + wheelchair
+}
+
+#if !defined(_WIN32)
+
+fs::path get_executable() {
+#if defined(__APPLE__)
+  auto size = std::uint32_t{0U};
+  _NSGetExecutablePath(nullptr, &size);
+  auto path = std::string(size, '\0');
+  utl::verify(_NSGetExecutablePath(path.data(), &size) == 0,
+              "unable to locate executable");
+  return fs::canonical(path.c_str());
+#else
+  auto ec = std::error_code{};
+  auto const self = fs::read_symlink("/proc/self/exe", ec);
+  utl::verify(!ec, "unable to locate executable: {}", ec.message());
+  return self;
+#endif
+}
+
+// Runs the executable without a shell, output goes to `log`.
+// Returns the exit code.
+int run_process(fs::path const& exe,
+                std::vector<std::string> const& args,
+                fs::path const& log) {
+  auto argv = std::vector<char*>{};
+  auto const exe_str = exe.string();
+  argv.push_back(const_cast<char*>(exe_str.c_str()));
+  for (auto const& a : args) {
+    argv.push_back(const_cast<char*>(a.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  auto const log_str = log.string();
+  auto actions = posix_spawn_file_actions_t{};
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, log_str.c_str(),
+                                   O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+
+  auto pid = pid_t{};
+  auto const error = posix_spawn(&pid, exe_str.c_str(), &actions, nullptr,
+                                 argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  utl::verify(error == 0, "unable to start {}: {}", exe_str,
+              std::strerror(error));
+
+  auto status = 0;
+  while (waitpid(pid, &status, 0) == -1) {
+    utl::verify(errno == EINTR, "waitpid failed: {}", std::strerror(errno));
+  }
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+#endif
+
+std::vector<fs::path> run_footpath_shards(n::timetable const& tt,
+                                          fs::path const& data_path,
+                                          unsigned const n_shards,
+                                          cista::hash_t const key,
+                                          unsigned const max_workers) {
+  auto ec = std::error_code{};
+  fs::create_directories(data_path / "footpaths", ec);
+
+  auto const shards = get_footpath_shards(tt, n_shards);
+  auto paths = std::vector<fs::path>{};
+  auto todo = std::vector<unsigned>{};
+  for (auto i = 0U; i != n_shards; ++i) {
+    auto const& p = paths.emplace_back(
+        get_footpath_shard_path(data_path, i, n_shards));
+    if (is_complete(p, key, shards[i].size())) {
+      fmt::println(std::clog, "  -> shard {}: done", i);
+    } else {
+      todo.push_back(i);
+    }
+  }
+
+  if (!todo.empty()) {
+#if defined(_WIN32)
+    throw utl::fail("footpath shard workers are not supported on Windows");
+#else
+    auto const exe = get_executable();
+    auto next = std::atomic_size_t{0U};
+    auto const run = [&]() {
+      for (auto j = next++; j < todo.size(); j = next++) {
+        auto const i = todo[j];
+        auto const log =
+            data_path / "logs" / fmt::format("footpaths-{}.txt", i);
+        fmt::println(std::clog, "  -> shard {}: started, log: {}", i,
+                     log.generic_string());
+        try {
+          auto const ret = run_process(
+              exe,
+              {"footpaths", "--data", data_path.string(), "--shard",
+               std::to_string(i), "--shards", std::to_string(n_shards),
+               "--key", std::to_string(key)},
+              log);
+          fmt::println(std::clog, "  -> shard {}: exit code {}", i, ret);
+        } catch (std::exception const& e) {
+          fmt::println(std::clog, "  -> shard {}: {}", i, e.what());
+        }
+      }
+    };
+
+    auto workers = std::vector<std::jthread>{};
+    auto const n_workers =
+        std::min(std::max(max_workers, 1U), static_cast<unsigned>(todo.size()));
+    fmt::println(std::clog, "  -> {} shards with {} workers", todo.size(),
+                 n_workers);
+    for (auto i = 0U; i != n_workers; ++i) {
+      workers.emplace_back(run);
+    }
+    workers.clear();  // join
+#endif
+  }
+
+  for (auto i = 0U; i != n_shards; ++i) {
+    utl::verify(is_complete(paths[i], key, shards[i].size()),
+                "footpath shard {} failed, see logs/footpaths-{}.txt", i, i);
+  }
+  return paths;
+}
+
+}  // namespace motis
\ No newline at end of file
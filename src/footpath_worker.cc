@@ -0,0 +1,51 @@
+#include <filesystem>
+#include <iostream>
+
+#include "boost/program_options.hpp"
+
+#include "utl/progress_tracker.h"
+
+#include "motis/footpath_shards.h"
+
+namespace bpo = boost::program_options;
+namespace fs = std::filesystem;
+
+namespace motis {
+
+int footpaths(int ac, char** av) {
+  auto data_path = fs::path{"data"};
+  auto shard = 0U;
+  auto n_shards = 1U;
+  auto key = cista::hash_t{0U};
+
+  auto desc = bpo::options_description{"Options"};
+  desc.add_options()  //
+      ("help,h", "produce this help message")  //
+      ("data,d", bpo::value(&data_path)->default_value(data_path),
+       "data path")  //
+      ("shard", bpo::value(&shard)->required(), "shard to compute")  //
+      ("shards", bpo::value(&n_shards)->required(), "number of shards")  //
+      ("key", bpo::value(&key)->required(),
+       "checkpoint key (set by motis import)");
+
+  auto vm = bpo::variables_map{};
+  bpo::store(bpo::command_line_parser(ac, av).options(desc).run(), vm);
+  if (vm.count("help")) {
+    std::cout << desc << "\n";
+    return 0;
+  }
+
+  try {
+    bpo::notify(vm);
+    auto const pt = utl::activate_progress_tracker("footpaths");
+    auto const silencer = utl::global_progress_bars{true};
+    compute_footpath_shard(data_path, shard, n_shards, key);
+  } catch (std::exception const& e) {
+    fmt::println("unable to compute footpath shard: {}", e.what());
+    return 1;
+  }
+
+  return 0;
+}
+
+}  // namespace motis
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "motis/geo_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MOTIS_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace motis {
+
+namespace {
+
+constexpr auto const kEarthRadius = 6371000.0;
+constexpr auto const kMetersPerDegree =
+    kEarthRadius * std::numbers::pi / 180.0;
+
+// Meters per degree latitude / longitude around `x`.
+struct projection {
+  explicit projection(geo::latlng const& origin)
+      : x_{origin},
+        lat_scale_{kMetersPerDegree},
+        lng_scale_{kMetersPerDegree *
+                   std::cos(origin.lat_ * std::numbers::pi / 180.0)} {}
+
+  double x(geo::latlng const& q) const {
+    return (q.lng_ - x_.lng_) * lng_scale_;
+  }
+
+  double y(geo::latlng const& q) const {
+    return (q.lat_ - x_.lat_) * lat_scale_;
+  }
+
+  geo::latlng x_;
+  double lat_scale_, lng_scale_;
+};
+
+struct closest {
+  void update(std::span<geo::latlng const> polyline,
+              std::size_t const segment,
+              double const t,
+              double const dist_sq) {
+    if (dist_sq < dist_sq_) {
+      auto const& a = polyline[segment];
+      auto const& b = polyline[segment + 1U];
+      dist_sq_ = dist_sq;
+      pos_ = {a.lat_ + t * (b.lat_ - a.lat_), a.lng_ + t * (b.lng_ - a.lng_)};
+    }
+  }
+
+  geo::latlng pos_;
+  double dist_sq_;
+};
+
+void approx_distances_scalar(projection const& p,
+                             std::span<geo::latlng const> points,
+                             std::span<double> out) {
+  for (auto i = 0U; i != points.size(); ++i) {
+    auto const dx = p.x(points[i]), dy = p.y(points[i]);
+    out[i] = std::sqrt(dx * dx + dy * dy);
+  }
+}
+
+// Projects `x` onto the segments [first, polyline.size() - 1).
+void closest_on_segments_scalar(projection const& p,
+                                std::span<geo::latlng const> polyline,
+                                std::size_t const first,
+                                closest& c) {
+  for (auto i = first; i + 1U < polyline.size(); ++i) {
+    auto const ax = p.x(polyline[i]), ay = p.y(polyline[i]);
+    auto const abx = p.x(polyline[i + 1U]) - ax;
+    auto const aby = p.y(polyline[i + 1U]) - ay;
+    auto const len_sq = abx * abx + aby * aby;
+    auto const t = len_sq == 0.0
+                       ? 0.0
+                       : std::clamp(-(ax * abx + ay * aby) / len_sq, 0.0, 1.0);
+    auto const cx = ax + t * abx, cy = ay + t * aby;
+    c.update(polyline, i, t, cx * cx + cy * cy);
+  }
+}
+
+#ifdef MOTIS_AVX2_KERNELS
+
+static_assert(sizeof(geo::latlng) == 2U * sizeof(double));
+
+// Four points (= eight interleaved lat/lng doubles) per iteration.
+__attribute__((target("avx2"))) void approx_distances_avx2(
+    projection const& p,
+    std::span<geo::latlng const> points,
+    std::span<double> out) {
+  auto const origin =
+      _mm256_setr_pd(p.x_.lat_, p.x_.lng_, p.x_.lat_, p.x_.lng_);
+  auto const scale =
+      _mm256_setr_pd(p.lat_scale_, p.lng_scale_, p.lat_scale_, p.lng_scale_);
+  auto const data = reinterpret_cast<double const*>(points.data());
+
+  auto i = std::size_t{0U};
+  for (; i + 4U <= points.size(); i += 4U) {
+    auto const a = _mm256_mul_pd(
+        _mm256_sub_pd(_mm256_loadu_pd(data + 2U * i), origin), scale);
+    auto const b = _mm256_mul_pd(
+        _mm256_sub_pd(_mm256_loadu_pd(data + 2U * i + 4U), origin), scale);
+
+    // hadd yields [d0, d2, d1, d3], reorder to [d0, d1, d2, d3]
+    auto const sum = _mm256_hadd_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b));
+    auto const ordered = _mm256_permute4x64_pd(sum, 0b11011000);
+    _mm256_storeu_pd(out.data() + i, _mm256_sqrt_pd(ordered));
+  }
+
+  approx_distances_scalar(p, points.subspan(i), out.subspan(i));
+}
+
+// Four segments per iteration, coordinates are gathered into lanes.
+__attribute__((target("avx2"))) void closest_on_segments_avx2(
+    projection const& p,
+    std::span<geo::latlng const> polyline,
+    closest& c) {
+  auto const x_lat = _mm256_set1_pd(p.x_.lat_);
+  auto const x_lng = _mm256_set1_pd(p.x_.lng_);
+  auto const lat_scale = _mm256_set1_pd(p.lat_scale_);
+  auto const lng_scale = _mm256_set1_pd(p.lng_scale_);
+  auto const zero = _mm256_setzero_pd();
+  auto const one = _mm256_set1_pd(1.0);
+  auto const stride = _mm256_setr_epi64x(0, 2, 4, 6);
+  auto const data = reinterpret_cast<double const*>(polyline.data());
+
+  auto t = std::array<double, 4U>{};
+  auto dist_sq = std::array<double, 4U>{};
+  auto i = std::size_t{0U};
+  for (; i + 4U < polyline.size(); i += 4U) {
+    auto const base = data + 2U * i;
+    auto const ax = _mm256_mul_pd(
+        _mm256_sub_pd(_mm256_i64gather_pd(base + 1U, stride, 8), x_lng),
+        lng_scale);
+    auto const ay = _mm256_mul_pd(
+        _mm256_sub_pd(_mm256_i64gather_pd(base, stride, 8), x_lat), lat_scale);
+    auto const abx = _mm256_sub_pd(
+        _mm256_mul_pd(
+            _mm256_sub_pd(_mm256_i64gather_pd(base + 3U, stride, 8), x_lng),
+            lng_scale),
+        ax);
+    auto const aby = _mm256_sub_pd(
+        _mm256_mul_pd(
+            _mm256_sub_pd(_mm256_i64gather_pd(base + 2U, stride, 8), x_lat),
+            lat_scale),
+        ay);
+
+    auto const len_sq =
+        _mm256_add_pd(_mm256_mul_pd(abx, abx), _mm256_mul_pd(aby, aby));
+    auto const dot =
+        _mm256_add_pd(_mm256_mul_pd(ax, abx), _mm256_mul_pd(ay, aby));
+    auto const degenerate = _mm256_cmp_pd(len_sq, zero, _CMP_EQ_OQ);
+    auto const t_raw = _mm256_blendv_pd(
+        _mm256_div_pd(_mm256_sub_pd(zero, dot), len_sq), zero, degenerate);
+    auto const t_clamped = _mm256_min_pd(_mm256_max_pd(t_raw, zero), one);
+
+    auto const cx = _mm256_add_pd(ax, _mm256_mul_pd(t_clamped, abx));
+    auto const cy = _mm256_add_pd(ay, _mm256_mul_pd(t_clamped, aby));
+    _mm256_storeu_pd(
+        dist_sq.data(),
+        _mm256_add_pd(_mm256_mul_pd(cx, cx), _mm256_mul_pd(cy, cy)));
+    _mm256_storeu_pd(t.data(), t_clamped);
+
+    for (auto j = 0U; j != 4U; ++j) {
+      c.update(polyline, i + j, t[j], dist_sq[j]);
+    }
+  }
+
+  closest_on_segments_scalar(p, polyline, i, c);
+}
+
+#endif
+
+bool has_avx2() {
+#ifdef MOTIS_AVX2_KERNELS
+  static auto const avx2 = __builtin_cpu_supports("avx2") != 0;
+  return avx2;
+#else
+  return false;
+#endif
+}
+
+}  // namespace
+
+void approx_distances(geo::latlng const& x,
+                      std::span<geo::latlng const> points,
+                      std::span<double> out) {
+  assert(out.size() >= points.size());
+  auto const p = projection{x};
+#ifdef MOTIS_AVX2_KERNELS
+  if (has_avx2()) {
+    approx_distances_avx2(p, points, out);
+    return;
+  }
+#endif
+  approx_distances_scalar(p, points, out);
+}
+
+std::pair<geo::latlng, double> closest_on_polyline(
+    geo::latlng const& x, std::span<geo::latlng const> polyline) {
+  assert(!polyline.empty());
+  auto const p = projection{x};
+  auto const dx = p.x(polyline[0]), dy = p.y(polyline[0]);
+  auto c = closest{.pos_ = polyline[0], .dist_sq_ = dx * dx + dy * dy};
+#ifdef MOTIS_AVX2_KERNELS
+  if (has_avx2()) {
+    closest_on_segments_avx2(p, polyline, c);
+    return {c.pos_, std::sqrt(c.dist_sq_)};
+  }
+#endif
+  closest_on_segments_scalar(p, polyline, 0U, c);
+  return {c.pos_, std::sqrt(c.dist_sq_)};
+}
+
+char const* geo_kernels_impl() { return has_avx2() ? "avx2" : "scalar"; }
+
+}  // namespace motis
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "motis/hash_file.h"
+
+#include <algorithm>
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+#include "boost/json.hpp"
+
+#include "cista/mmap.h"
+
+#include "utl/parallel_for.h"
+
+namespace fs = std::filesystem;
+
+namespace motis {
+
+constexpr auto const kChunkSize = std::size_t{64U} * 1024U * 1024U;
+
+file_hash_cache file_hash_cache::read(fs::path const& p) {
+  auto ec = std::error_code{};
+  if (!fs::is_regular_file(p, ec)) {
+    return {};
+  }
+  auto const mmap =
+      cista::mmap{p.generic_string().c_str(), cista::mmap::protection::READ};
+  return {boost::json::value_to<decltype(entries_)>(
+      boost::json::parse(mmap.view()))};
+}
+
+void file_hash_cache::write(fs::path const& p) const {
+  std::ofstream{p} << boost::json::serialize(boost::json::value_from(entries_));
+}
+
+std::vector<std::uint64_t> get_file_key(fs::path const& p) {
+  auto const mtime = static_cast<std::uint64_t>(
+      fs::last_write_time(p).time_since_epoch().count());
+  auto inode = std::uint64_t{0U};
+#if !defined(_WIN32)
+  struct stat s {};
+  if (::stat(p.generic_string().c_str(), &s) == 0) {
+    inode = static_cast<std::uint64_t>(s.st_ino);
+  }
+#endif
+  return {fs::file_size(p), mtime, inode};
+}
+
+// Chunks are hashed in parallel, the result is the hash of all chunk hashes.
+cista::hash_t hash_content(fs::path const& p, std::uint64_t const size) {
+  auto h = cista::hash_combine(cista::BASE_HASH, size);
+  if (size == 0U) {
+    return h;
+  }
+
+  auto const mmap =
+      cista::mmap{p.generic_string().c_str(), cista::mmap::protection::READ};
+  auto const content = mmap.view();
+  auto chunks = std::vector<cista::hash_t>((content.size() + kChunkSize - 1U) /
+                                           kChunkSize);
+  utl::parallel_for_run(chunks.size(), [&](std::size_t const i) {
+    chunks[i] = cista::hash(content.substr(i * kChunkSize, kChunkSize));
+  });
+  for (auto const chunk : chunks) {
+    h = cista::hash_combine(h, chunk);
+  }
+  return h;
+}
+
+cista::hash_t hash_regular_file(fs::path const& p, file_hash_cache& cache) {
+  auto key = get_file_key(p);
+  auto& entry = cache.entries_[fs::absolute(p).generic_string()];
+  if (entry.size() == key.size() + 1U &&
+      std::equal(begin(key), end(key), begin(entry))) {
+    return entry.back();
+  }
+
+  auto const h = hash_content(p, key.front());
+  entry = std::move(key);
+  entry.emplace_back(h);
+  return h;
+}
+
+cista::hash_t hash_file(fs::path const& p, file_hash_cache& cache) {
+  if (p.generic_string().starts_with("\n#")) {
+    return cista::hash(p.generic_string());
+  }
+
+  if (!fs::is_directory(p)) {
+    return hash_regular_file(p, cache);
+  }
+
+  auto files = std::vector<fs::path>{};
+  for (auto const& e : fs::recursive_directory_iterator{p}) {
+    if (e.is_regular_file()) {
+      files.emplace_back(e.path());
+    }
+  }
+  std::sort(begin(files), end(files));
+
+  auto h = cista::BASE_HASH;
+  for (auto const& f : files) {
+    h = cista::hash(fs::relative(f, p).generic_string(), h);
+    h = cista::hash_combine(h, hash_regular_file(f, cache));
+  }
+  return h;
+}
+
+}  // namespace motis
\ No newline at end of file
@@ -1,10 +1,19 @@
 #include "motis/import.h"
 
+#include <condition_variable>
+#include <exception>
 #include <fstream>
+#include <limits>
 #include <map>
+#include <mutex>
 #include <ostream>
+#include <thread>
 #include <vector>
 
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
 #include "boost/json.hpp"
 
 #include "fmt/ranges.h"
@@ -13,7 +22,9 @@
 
 #include "adr/area_database.h"
 
+#include "utl/erase.h"
 #include "utl/erase_if.h"
+#include "utl/helpers/algorithm.h"
 #include "utl/read_file.h"
 #include "utl/to_vec.h"
 
@@ -46,7 +57,11 @@
 #include "motis/clog_redirect.h"
 #include "motis/compute_footpaths.h"
 #include "motis/data.h"
+#include "motis/footpath_shards.h"
+#include "motis/hash_file.h"
+#include "motis/shapes.h"
 #include "motis/tag_lookup.h"
+#include "motis/trip_id_index.h"
 #include "motis/tt_location_rtree.h"
 
 namespace fs = std::filesystem;
@@ -58,8 +73,9 @@ namespace motis {
 
 constexpr auto const kAdrBinaryVersion = 1U;
 constexpr auto const kOsrBinaryVersion = 2U;
-constexpr auto const kNigiriBinaryVersion = 3U;
-constexpr auto const kMatchesBinaryVersion = 4U;
+constexpr auto const kNigiriBinaryVersion = 4U;
+constexpr auto const kMatchesBinaryVersion = 7U;
+constexpr auto const kShapesBinaryVersion = 2U;
 
 using meta_entry_t = std::pair<std::string, std::uint64_t>;
 using meta_t = std::map<std::string, std::uint64_t>;
@@ -94,25 +110,35 @@ struct task {
 
   void load() { load_(); }
 
+  // Every task reports to its own tracker `pt_`, passed to `run_`.
+  // Libraries (nigiri, osr, adr, tiles) only report to the process-wide
+  // active tracker. Tasks using them activate their tracker and never run
+  // at the same time (see run_tasks).
   void run(fs::path const& data_path) {
-    auto const pt = utl::activate_progress_tracker(name_);
+    if (uses_active_tracker_) {
+      pt_ = utl::activate_progress_tracker(name_);
+    }
     auto const redirect = clog_redirect{
         (data_path / "logs" / (name_ + ".txt")).generic_string().c_str()};
-    run_();
+    run_(pt_);
     write_hashes(data_path, name_, hashes_);
-    pt->out_ = 100;
-    pt->status("FINISHED");
+    pt_->out_ = 100;
+    pt_->status("FINISHED");
   }
 
   std::string name_;
   std::function<bool()> should_run_;
-  std::function<bool()> ready_;
-  std::function<void()> run_;
+  std::function<void(utl::progress_tracker_ptr const&)> run_;
   std::function<void()> load_;
   meta_t hashes_;
+  std::vector<std::string> dependencies_{};
+  bool uses_active_tracker_{false};
   utl::progress_tracker_ptr pt_{};
 };
 
+// task::uses_active_tracker_ of tasks calling into libraries.
+constexpr auto const kActiveTracker = true;
+
 }  // namespace motis
 
 template <>
@@ -120,17 +146,99 @@ struct fmt::formatter<motis::task> : fmt::ostream_formatter {};
 
 namespace motis {
 
-cista::hash_t hash_file(fs::path const& p) {
-  if (p.generic_string().starts_with("\n#")) {
-    return cista::hash(p.generic_string());
+// Size of a file or of all files in a directory, 0 for inline data.
+std::uint64_t input_size(fs::path const& p) {
+  auto ec = std::error_code{};
+  if (fs::is_regular_file(p, ec)) {
+    return fs::file_size(p);
+  }
+  auto size = std::uint64_t{0U};
+  if (fs::is_directory(p, ec)) {
+    for (auto const& e : fs::recursive_directory_iterator{p}) {
+      if (e.is_regular_file()) {
+        size += e.file_size();
+      }
+    }
+  }
+  return size;
+}
+
+std::uint64_t physical_memory() {
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+  auto const pages = sysconf(_SC_PHYS_PAGES);
+  auto const page_size = sysconf(_SC_PAGESIZE);
+  if (pages > 0 && page_size > 0) {
+    return static_cast<std::uint64_t>(pages) *
+           static_cast<std::uint64_t>(page_size);
+  }
+#endif
+  return std::numeric_limits<std::uint64_t>::max();
+}
+
+// Runs every task as soon as all its dependencies are finished, up to
+// `n_tasks` at the same time. Tasks that use the active progress tracker
+// run one after another.
+void run_tasks(std::vector<task>& pending,
+               fs::path const& data_path,
+               config::import_budget const& budget) {
+  auto mutex = std::mutex{};
+  auto cv = std::condition_variable{};
+  auto running = std::vector<task const*>{};
+  auto threads = std::vector<std::jthread>{};
+  auto error = std::exception_ptr{};
+
+  auto const is_waiting_for = [&](std::string const& name) {
+    return utl::any_of(pending,
+                       [&](task const& t) { return t.name_ == name; }) ||
+           utl::any_of(running,
+                       [&](task const* t) { return t->name_ == name; });
+  };
+  auto const uses_active_tracker = [](task const* t) {
+    return t->uses_active_tracker_;
+  };
+  auto const can_start = [&](task const& t) {
+    return utl::none_of(t.dependencies_, is_waiting_for) &&
+           running.size() < std::max(1U, budget.n_tasks_) &&
+           !(t.uses_active_tracker_ &&
+             utl::any_of(running, uses_active_tracker));
+  };
+
+  auto lock = std::unique_lock{mutex};
+  while (!error && (!pending.empty() || !running.empty())) {
+    auto const it = utl::find_if(pending, can_start);
+    if (it == end(pending)) {
+      utl::verify(!running.empty(), "no task to run, remaining tasks: {}",
+                  pending);
+      cv.wait(lock);
+      continue;
+    }
+
+    auto next = std::make_unique<task>(std::move(*it));
+    pending.erase(it);
+    running.emplace_back(next.get());
+    threads.emplace_back([&, t = std::move(next)]() {
+      auto e = std::exception_ptr{};
+      try {
+        t->run(data_path);
+      } catch (...) {
+        e = std::current_exception();
+      }
+
+      auto const guard = std::scoped_lock{mutex};
+      utl::erase(running, t.get());
+      if (e && !error) {
+        error = e;
+      }
+      cv.notify_one();
+    });
+  }
+  cv.wait(lock, [&]() { return running.empty(); });
+  lock.unlock();
+
+  threads.clear();
+  if (error) {
+    std::rethrow_exception(error);
   }
-  auto const mmap =
-      cista::mmap{p.generic_string().c_str(), cista::mmap::protection::READ};
-  return cista::hash_combine(
-      cista::hash(mmap.view().substr(
-          0U, std::min(mmap.size(),
-                       static_cast<std::size_t>(50U * 1024U * 1024U)))),
-      mmap.size());
 }
 
 data import(config const& c, fs::path const& data_path, bool const write) {
@@ -142,6 +250,11 @@ data import(config const& c, fs::path const& data_path, bool const write) {
 
   clog_redirect::set_enabled(write);
 
+  auto file_hashes = file_hash_cache::read(data_path / "meta" / "files.json");
+  auto const hash_file = [&](fs::path const& p) {
+    return motis::hash_file(p, file_hashes);
+  };
+
   auto tt_hash = std::pair{"timetable"s, cista::BASE_HASH};
   if (c.timetable_.has_value()) {
     auto& h = tt_hash.second;
@@ -174,28 +287,31 @@ data import(config const& c, fs::path const& data_path, bool const write) {
     }
   }
 
+  file_hashes.write(data_path / "meta" / "files.json");
+
   auto const osr_version = meta_entry_t{"osr_bin_ver", kOsrBinaryVersion};
   auto const adr_version = meta_entry_t{"adr_bin_ver", kAdrBinaryVersion};
   auto const n_version = meta_entry_t{"nigiri_bin_ver", kNigiriBinaryVersion};
   auto const matches_version =
       meta_entry_t{"matches_ver", kMatchesBinaryVersion};
+  auto const shapes_version = meta_entry_t{"shapes_ver", kShapesBinaryVersion};
 
   auto d = data{data_path};
 
   auto osr = task{"osr",
                   [&]() { return c.street_routing_; },
-                  [&]() { return true; },
-                  [&]() {
+                  [&](utl::progress_tracker_ptr const&) {
                     osr::extract(true, fs::path{*c.osm_}, data_path / "osr");
                     d.load_osr();
                   },
                   [&]() { d.load_osr(); },
-                  {osm_hash, osr_version}};
+                  {osm_hash, osr_version},
+                  {},
+                  kActiveTracker};
 
   auto adr = task{"adr",
                   [&]() { return c.geocoding_ || c.reverse_geocoding_; },
-                  [&]() { return true; },
-                  [&]() {
+                  [&](utl::progress_tracker_ptr const&) {
                     adr::extract(*c.osm_, data_path / "adr", data_path / "adr");
                     d.load_geocoder();
 
@@ -209,13 +325,19 @@ data import(config const& c, fs::path const& data_path, bool const write) {
                       d.load_reverse_geocoder();
                     }
                   },
-                  {osm_hash, adr_version}};
-
+                  {osm_hash, adr_version},
+                  {},
+                  kActiveTracker};
+
+  // osr_footpath moves the coordinates of a loaded timetable to the platform
+  // centers and writes it back to tt.bin. Only a timetable built in this
+  // run has the original coordinates the match fingerprints are based on.
+  auto tt_built = false;
   auto tt = task{
       "tt",
       [&]() { return c.timetable_.has_value(); },
-      [&]() { return true; },
-      [&]() {
+      [&](utl::progress_tracker_ptr const&) {
+        tt_built = true;
         auto const to_clasz_bool_array =
             [&](config::timetable::dataset const& d) {
               auto a = std::array<bool, n::kNumClasses>{};
@@ -243,11 +365,11 @@ data import(config const& c, fs::path const& data_path, bool const write) {
               nl::read_assistance(f.view()));
         }
 
-        //        auto shapes = std::unique_ptr<n::shape_storage_t>();
-        //        if (t.with_shapes_) {
-        //          shapes = std::make_unique<n::shape_storage_t>(
-        //              n::create_shape_storage(data_path / "shapes"));
-        //        }
+        auto shapes = std::unique_ptr<n::shape_storage_t>();
+        if (t.with_shapes_) {
+          shapes = std::make_unique<n::shape_storage_t>(
+              n::create_shape_storage(data_path / "nigiri_shapes"));
+        }
 
         d.tags_ = cista::wrapped{cista::raw::make_unique<tag_lookup>()};
         d.tt_ = cista::wrapped{cista::raw::make_unique<n::timetable>(nl::load(
@@ -269,7 +391,9 @@ data import(config const& c, fs::path const& data_path, bool const write) {
              .merge_dupes_intra_src_ = t.merge_dupes_intra_src_,
              .merge_dupes_inter_src_ = t.merge_dupes_inter_src_,
              .max_footpath_length_ = t.max_footpath_length_},
-            interval, assistance.get(), nullptr, t.ignore_errors_))};
+            interval, assistance.get(), shapes.get(), t.ignore_errors_))};
+        d.tags_->build_ids(*d.tt_);
+        d.trip_ids_ = std::make_unique<trip_id_index>(*d.tt_);
         d.location_rtee_ =
             std::make_unique<point_rtree<nigiri::location_idx_t>>(
                 create_location_rtree(*d.tt_));
@@ -280,13 +404,31 @@ data import(config const& c, fs::path const& data_path, bool const write) {
         }
       },
       [&]() { d.load_tt(); },
-      {tt_hash, n_version}};
+      {tt_hash, n_version},
+      {},
+      kActiveTracker};
+
+  // Waits for osr_footpath: it moves the stop coordinates the shapes are
+  // matched against.
+  auto shapes = task{
+      "shapes",
+      [&]() {
+        return c.timetable_.has_value() && c.timetable_->with_shapes_;
+      },
+      [&](utl::progress_tracker_ptr const&) {
+        auto const src = n::create_shape_storage(
+            data_path / "nigiri_shapes", cista::mmap::protection::READ);
+        build_shapes(*d.tt_, src, data_path / "shapes");
+        d.load_shapes();
+      },
+      [&]() { d.load_shapes(); },
+      {tt_hash, n_version, shapes_version},
+      {"tt", "osr_footpath"}};
 
   auto adr_extend =
       task{"adr_extend",
            [&]() { return c.geocoding_ && c.timetable_.has_value(); },
-           [&]() { return d.tt_ && d.t_; },
-           [&]() {
+           [&](utl::progress_tracker_ptr const&) {
              auto const area_db = adr::area_database{
                  data_path / "adr", cista::mmap::protection::READ};
              adr_extend_tt(*d.tt_, area_db, *d.t_);
@@ -295,47 +437,132 @@ data import(config const& c, fs::path const& data_path, bool const write) {
              }
            },
            [&]() {},
-           {tt_hash, osm_hash, adr_version, n_version}};
+           {tt_hash, osm_hash, adr_version, n_version},
+           {"tt", "adr"}};
 
   auto osr_footpath =
       task{"osr_footpath",
            [&]() { return c.osr_footpath_; },
-           [&]() { return d.tt_ && d.w_ && d.l_ && d.pl_; },
-           [&]() {
+           [&](utl::progress_tracker_ptr const& pt) {
+             auto const checkpoint = data_path / "footpaths.checkpoint";
+             auto const key =
+                 cista::build_hash(tt_hash.second, osm_hash.second,
+                                   kOsrBinaryVersion, kNigiriBinaryVersion,
+                                   kMatchesBinaryVersion);
+             auto opt = footpath_options{
+                 .checkpoint_ = write ? checkpoint : fs::path{},
+                 .checkpoint_key_ = key,
+                 .pt_ = pt};
+
+             // Workers read tt.bin, osr and the matches from disk. Like this
+             // process, each one holds them in memory.
+             auto const budget =
+                 c.import_budget_.value_or(config::import_budget{});
+             auto const n_shards = std::min(
+                 budget.footpath_shards_.value_or(1U), kMaxFootpathShards);
+             if (write && n_shards > 1U) {
+               auto const memory_budget =
+                   budget.memory_mb_.has_value()
+                       ? *budget.memory_mb_ * 1024U * 1024U
+                       : physical_memory();
+               auto const worker_memory =
+                   std::max(std::uint64_t{1U},
+                            input_size(data_path / "tt.bin") +
+                                input_size(data_path / "osr") +
+                                input_size(data_path / "matches.bin"));
+               auto const max_workers = static_cast<unsigned>(std::min(
+                   std::uint64_t{budget.n_tasks_},
+                   std::max(memory_budget / worker_memory, std::uint64_t{1U}) -
+                       1U));
+               opt.shard_results_ = run_footpath_shards(
+                   *d.tt_, data_path, n_shards, key, max_workers);
+             }
+
              auto const elevator_footpath_map =
-                 compute_footpaths(*d.w_, *d.l_, *d.pl_, *d.tt_, true);
+                 compute_footpaths(*d.w_, *d.l_, *d.tt_, *d.platform_centers_,
+                                   *d.matches_, *d.positions_, opt);
 
              if (write) {
                cista::write(data_path / "elevator_footpath_map.bin",
                             elevator_footpath_map);
                d.tt_->write(data_path / "tt.bin");
+               fs::remove(checkpoint);
+               fs::remove_all(data_path / "footpaths");
              }
            },
            [&]() {},
-           {tt_hash, osm_hash, osr_version, n_version}};
+           {tt_hash, osm_hash, osr_version, n_version, matches_version},
+           {"tt", "osr", "adr_extend", "matches"}};
 
   auto matches =
       task{"matches",
            [&]() { return c.timetable_ && c.street_routing_; },
-           [&]() { return d.tt_ && d.w_ && d.pl_; },
-           [&]() {
+           [&](utl::progress_tracker_ptr const&) {
+             // Platform indices are only stable if the street data did not
+             // change. Then, only new or changed locations are matched.
+             // Fingerprints need unadjusted coordinates (see tt_built).
+             auto const prev = read_hashes(data_path, "matches");
+             auto const is_unchanged = [&](meta_entry_t const& e) {
+               auto const it = prev.find(e.first);
+               return it != end(prev) && it->second == e.second;
+             };
+             auto const incremental =
+                 tt_built && is_unchanged(osm_hash) && is_unchanged(osr_version) &&
+                 is_unchanged(matches_version) &&
+                 fs::is_regular_file(data_path / "matches.bin") &&
+                 fs::is_regular_file(data_path / "match_fingerprints.bin") &&
+                 fs::is_regular_file(data_path / "platform_centers.bin");
+
+             d.platform_centers_ =
+                 incremental
+                     ? cista::read<platform_centers_t>(data_path /
+                                                       "platform_centers.bin")
+                     : cista::wrapped<platform_centers_t>{
+                           cista::raw::make_unique<platform_centers_t>(
+                               get_platform_centers(*d.pl_, *d.w_))};
+
+             auto const fingerprints =
+                 get_match_fingerprints(*d.tt_, *d.tags_);
              d.matches_ = cista::wrapped<platform_matches_t>{
                  cista::raw::make_unique<platform_matches_t>(
-                     get_matches(*d.tt_, *d.pl_, *d.w_))};
+                     incremental
+                         ? update_matches(
+                               *d.tt_, *d.pl_, *d.w_, *d.platform_centers_,
+                               fingerprints,
+                               *cista::read<match_fingerprints_t>(
+                                   data_path / "match_fingerprints.bin"),
+                               *cista::read<platform_matches_t>(
+                                   data_path / "matches.bin"))
+                         : get_matches(*d.tt_, *d.pl_, *d.w_,
+                                       *d.platform_centers_))};
+             d.positions_ = cista::wrapped<location_positions_t>{
+                 cista::raw::make_unique<location_positions_t>(
+                     get_location_positions(*d.tt_, *d.pl_, *d.w_,
+                                            *d.platform_centers_,
+                                            *d.matches_))};
+             d.route_names_ = cista::wrapped<location_route_names_t>{
+                 cista::raw::make_unique<location_route_names_t>(
+                     get_location_route_names(*d.tt_))};
              if (write) {
+               if (!incremental) {
+                 cista::write(data_path / "platform_centers.bin",
+                              *d.platform_centers_);
+               }
                cista::write(data_path / "matches.bin", *d.matches_);
+               cista::write(data_path / "match_fingerprints.bin",
+                            fingerprints);
+               cista::write(data_path / "positions.bin", *d.positions_);
+               cista::write(data_path / "route_names.bin", *d.route_names_);
              }
            },
            [&]() { d.load_matches(); },
-           {tt_hash, osm_hash, osr_version, n_version, matches_version}};
+           {tt_hash, osm_hash, osr_version, n_version, matches_version},
+           {"tt", "osr"}};
 
   auto tiles = task{
       "tiles",
       [&]() { return c.tiles_.has_value(); },
-      [&]() { return true; },
-      [&]() {
-        auto const progress_tracker = utl::get_active_progress_tracker();
-
+      [&](utl::progress_tracker_ptr const& progress_tracker) {
         auto const dir = data_path / "tiles";
         auto const path = (dir / "tiles.mdb").string();
 
@@ -375,10 +602,13 @@ data import(config const& c, fs::path const& data_path, bool const write) {
         ::tiles::prepare_tiles(db_handle, pack_handle, 10);
       },
       []() {},
-      {osm_hash, tiles_hash}};
+      {osm_hash, tiles_hash},
+      {},
+      kActiveTracker};
 
   auto tasks =
-      std::vector<task>{osr, adr, tt, adr_extend, osr_footpath, tiles, matches};
+      std::vector<task>{osr,          adr,   tt,      adr_extend,
+                        osr_footpath, tiles, matches, shapes};
   utl::erase_if(tasks, [&](auto&& t) {
     if (!t.should_run_()) {
       return true;
@@ -396,14 +626,8 @@ data import(config const& c, fs::path const& data_path, bool const write) {
     t.pt_ = utl::activate_progress_tracker(t.name_);
   }
 
-  while (!tasks.empty()) {
-    auto const task_it =
-        utl::find_if(tasks, [](task const& t) { return t.ready_(); });
-    utl::verify(task_it != end(tasks), "no task to run, remaining tasks: {}",
-                tasks);
-    task_it->run(data_path);
-    tasks.erase(task_it);
-  }
+  run_tasks(tasks, data_path,
+            c.import_budget_.value_or(config::import_budget{}));
 
   std::ofstream{(data_path / "config.yml").generic_string()} << c << "\n";
 
@@ -0,0 +1,193 @@
+#include "motis/itinerary_watch.h"
+
+#include <algorithm>
+
+#include "utl/enumerate.h"
+#include "utl/erase_if.h"
+#include "utl/pairwise.h"
+#include "utl/verify.h"
+
+#include "nigiri/rt/frun.h"
+#include "nigiri/rt/rt_timetable.h"
+#include "nigiri/timetable.h"
+
+namespace n = nigiri;
+
+namespace motis {
+
+// nullopt if there is no footpath between the two stops.
+std::optional<n::duration_t> get_min_transfer_time(
+    n::timetable const& tt,
+    n::location_idx_t const from,
+    n::location_idx_t const to) {
+  if (from == to) {
+    return tt.locations_.transfer_time_[from];
+  }
+  for (auto const fp : tt.locations_.footpaths_out_[0][from]) {
+    if (fp.target() == to) {
+      return fp.duration();
+    }
+  }
+  return std::nullopt;
+}
+
+bool is_cancelled(n::timetable const& tt,
+                  n::rt_timetable const* rtt,
+                  n::transport const t) {
+  auto const& traffic_days =
+      rtt == nullptr
+          ? tt.bitfields_[tt.transport_traffic_days_[t.t_idx_]]
+          : rtt->bitfields_[rtt->transport_traffic_days_[t.t_idx_]];
+  return !traffic_days.test(to_idx(t.day_));
+}
+
+bool refresh(n::timetable const& tt,
+             n::rt_timetable const* rtt,
+             itinerary_watch::leg& l) {
+  auto const fr = n::rt::frun{tt, rtt, l.r_};
+  auto const enter = fr[l.enter_];
+  auto const exit = fr[l.exit_];
+  auto const dep = enter.time(n::event_type::kDep);
+  auto const arr = exit.time(n::event_type::kArr);
+  auto const cancelled = is_cancelled(tt, rtt, l.r_.t_) ||
+                         !enter.in_allowed() || !exit.out_allowed();
+  auto const changed =
+      dep != l.dep_ || arr != l.arr_ || cancelled != l.cancelled_;
+  l.dep_ = dep;
+  l.arr_ = arr;
+  l.dep_delay_ = enter.delay(n::event_type::kDep);
+  l.arr_delay_ = exit.delay(n::event_type::kArr);
+  l.is_rt_ = fr.is_rt();
+  l.cancelled_ = cancelled;
+  return changed;
+}
+
+void update_transfers(itinerary_watch::itinerary& x) {
+  for (auto i = 0U; i < x.transfers_.size(); ++i) {
+    auto const& a = x.legs_[i];
+    auto const& b = x.legs_[i + 1U];
+    auto& t = x.transfers_[i];
+    t.slack_ = std::chrono::duration_cast<n::duration_t>(b.dep_ - a.arr_) -
+               t.min_duration_.value_or(n::duration_t{0});
+    t.feasible_ = t.min_duration_.has_value() && !a.cancelled_ &&
+                  !b.cancelled_ && t.slack_ >= n::duration_t{0};
+  }
+}
+
+itinerary_watch::itinerary_watch(std::size_t const max_watches)
+    : max_watches_{std::max(max_watches, std::size_t{1U})} {}
+
+watch_id_t itinerary_watch::add(n::timetable const& tt,
+                                n::rt_timetable const* rtt,
+                                std::vector<leg_query> const& legs) {
+  auto x = itinerary{};
+  for (auto const& q : legs) {
+    utl::verify(q.r_.valid(), "watch: trip not found");
+
+    auto fr = n::rt::frun{tt, nullptr, q.r_};
+    fr.stop_range_.to_ = fr.size();
+    fr.stop_range_.from_ = 0U;
+
+    auto enter = std::optional<n::stop_idx_t>{};
+    auto exit = std::optional<n::stop_idx_t>{};
+    for (auto i = n::stop_idx_t{0U}; i != fr.stop_range_.to_; ++i) {
+      auto const l = fr[i].get_location_idx();
+      if (!enter.has_value() && l == q.from_) {
+        enter = i;
+      } else if (enter.has_value() && l == q.to_) {
+        exit = i;
+        break;
+      }
+    }
+    utl::verify(enter.has_value() && exit.has_value(),
+                "watch: stops not found in trip");
+
+    auto& l = x.legs_.emplace_back(
+        leg{.r_ = fr,  // NOLINT(cppcoreguidelines-slicing)
+            .enter_ = *enter,
+            .exit_ = *exit});
+    refresh(tt, rtt, l);
+  }
+
+  for (auto const [a, b] : utl::pairwise(legs)) {
+    x.transfers_.push_back(
+        {.min_duration_ = get_min_transfer_time(tt, a.to_, b.from_)});
+  }
+  update_transfers(x);
+
+  auto const lock = std::scoped_lock{mutex_};
+  while (itineraries_.size() >= max_watches_) {
+    erase(begin(itineraries_));
+  }
+
+  auto const id = next_id_++;
+  for (auto const [i, l] : utl::enumerate(x.legs_)) {
+    transport_legs_[l.r_.t_].emplace_back(id, static_cast<unsigned>(i));
+  }
+  itineraries_.emplace(id, std::move(x));
+  return id;
+}
+
+void itinerary_watch::remove(watch_id_t const id) {
+  auto const lock = std::scoped_lock{mutex_};
+  auto const it = itineraries_.find(id);
+  if (it != end(itineraries_)) {
+    erase(it);
+  }
+}
+
+void itinerary_watch::erase(std::map<watch_id_t, itinerary>::iterator it) {
+  auto const id = it->first;
+  for (auto const& l : it->second.legs_) {
+    auto const legs_it = transport_legs_.find(l.r_.t_);
+    if (legs_it != end(transport_legs_)) {
+      utl::erase_if(legs_it->second,
+                    [&](auto&& entry) { return entry.first == id; });
+      if (legs_it->second.empty()) {
+        transport_legs_.erase(legs_it);
+      }
+    }
+  }
+  itineraries_.erase(it);
+}
+
+std::optional<itinerary_watch::itinerary> itinerary_watch::get(
+    watch_id_t const id) const {
+  auto const lock = std::scoped_lock{mutex_};
+  auto const it = itineraries_.find(id);
+  return it == end(itineraries_) ? std::nullopt : std::optional{it->second};
+}
+
+std::size_t itinerary_watch::update(n::timetable const& tt,
+                                    n::rt_timetable const& rtt) {
+  auto const lock = std::scoped_lock{mutex_};
+  ++update_count_;
+
+  auto changed = hash_set<watch_id_t>{};
+  for (auto const& [t, legs] : transport_legs_) {
+    auto const& first = itineraries_.at(legs.front().first)
+                            .legs_[legs.front().second];
+    auto const touched =
+        rtt.resolve_rt(t) != n::rt_transport_idx_t::invalid() ||
+        first.is_rt_ || first.cancelled_ || is_cancelled(tt, &rtt, t);
+    if (!touched) {
+      continue;
+    }
+
+    for (auto const& [id, leg_idx] : legs) {
+      if (refresh(tt, &rtt, itineraries_.at(id).legs_[leg_idx])) {
+        changed.emplace(id);
+      }
+    }
+  }
+
+  for (auto const id : changed) {
+    auto& x = itineraries_.at(id);
+    update_transfers(x);
+    x.version_ = update_count_;
+  }
+
+  return changed.size();
+}
+
+}  // namespace motis
\ No newline at end of file
@@ -4,11 +4,13 @@
 
 #include "utl/concat.h"
 #include "utl/enumerate.h"
+#include "utl/get_or_create.h"
+#include "utl/helpers/algorithm.h"
 
 #include "osr/platforms.h"
 #include "osr/routing/route.h"
 
-#include "geo/polyline_format.h"
+#include "geo/polyline.h"
 
 #include "nigiri/common/split_duration.h"
 #include "nigiri/routing/journey.h"
@@ -19,6 +21,8 @@
 #include "nigiri/types.h"
 
 #include "motis/constants.h"
+#include "motis/polyline.h"
+#include "motis/shapes.h"
 #include "motis/tag_lookup.h"
 #include "motis/time_conv.h"
 #include "motis/timetable/clasz_to_mode.h"
@@ -47,7 +51,7 @@ api::Place to_place(nigiri::timetable const& tt,
                         return api::Place{
                             .name_ =
                                 std::string{tt.locations_.names_[l].view()},
-                            .stopId_ = tags.id(tt, l),
+                            .stopId_ = std::string{tags.id(l)},
                             .lat_ = pos.lat_,
                             .lon_ = pos.lng_};
                       }},
@@ -73,7 +77,7 @@ api::Place to_place(n::timetable const& tt,
         is_track ? std::optional{std::string{tt.locations_.names_.at(l).view()}}
                  : std::nullopt;
     return {.name_ = std::string{tt.locations_.names_[p].view()},
-            .stopId_ = tags.id(tt, l),
+            .stopId_ = std::string{tags.id(l)},
             .lat_ = pos.lat_,
             .lon_ = pos.lng_,
             .track_ = track,
@@ -81,6 +85,15 @@ api::Place to_place(n::timetable const& tt,
   }
 }
 
+std::int64_t place_table::get(n::timetable const& tt,
+                              tag_lookup const& tags,
+                              n::location_idx_t const l) {
+  return utl::get_or_create(idx_, l, [&]() {
+    places_.emplace_back(to_place(tt, tags, l, {}, {}));
+    return static_cast<std::int64_t>(places_.size() - 1U);
+  });
+}
+
 api::ModeEnum to_mode(osr::search_profile const m) {
   switch (m) {
     case osr::search_profile::kCarParkingWheelchair: [[fallthrough]];
@@ -93,6 +106,21 @@ api::ModeEnum to_mode(osr::search_profile const m) {
   std::unreachable();
 }
 
+api::EncodedPolyline to_encoded_polyline(std::span<geo::latlng const> line,
+                                         double const tolerance,
+                                         unsigned const precision,
+                                         std::pmr::memory_resource* mr) {
+  if (tolerance <= 0.0) {
+    return {.points_ = encode_polyline(line, precision),
+            .length_ = static_cast<std::int64_t>(line.size()),
+            .precision_ = precision};
+  }
+  auto const simplified = simplify(line, tolerance, mr);
+  return {.points_ = encode_polyline(simplified, precision),
+          .length_ = static_cast<std::int64_t>(simplified.size()),
+          .precision_ = precision};
+}
+
 api::Itinerary journey_to_response(
     osr::ways const& w,
     osr::lookup const& l,
@@ -102,12 +130,18 @@ api::Itinerary journey_to_response(
     elevators const* e,
     n::rt_timetable const* rtt,
     vector_map<nigiri::location_idx_t, osr::platform_idx_t> const& matches,
+    shapes const* shape_store,
     bool const wheelchair,
+    bool const debug,
+    double const geometry_tolerance,
+    unsigned const geometry_precision,
     n::routing::journey const& j,
     place_t const& start,
     place_t const& dest,
+    place_table* places,
     street_routing_cache_t& cache,
     osr::bitvec<osr::node_idx_t>& blocked_mem) {
+  auto const mr = cache.get_allocator().resource();
   auto const to_location = [&](n::location_idx_t const l) {
     switch (to_idx(l)) {
       case static_cast<n::location_idx_t::value_t>(n::special_station::kStart):
@@ -130,7 +164,9 @@ api::Itinerary journey_to_response(
     auto const s = e ? get_states_at(w, l, *e, t, from.pos_)
                      : std::optional{std::pair<nodes_t, states_t>{}};
     auto const& [e_nodes, e_states] = *s;
-    auto const key = std::tuple{from, to, profile, e_states};
+    auto const key = street_routing_cache_t::key_type{
+        from, to, profile,
+        std::pmr::vector<bool>{begin(e_states), end(e_states), mr}};
     auto const it = cache.find(key);
     auto const path =
         it != end(cache)
@@ -151,27 +187,34 @@ api::Itinerary journey_to_response(
       return;
     }
 
-    leg.legGeometryWithLevels_ =
-        utl::to_vec(path->segments_, [&](osr::path::segment const& s) {
-          return api::LevelEncodedPolyline{
-              .from_level_ = to_float(s.from_level_),
-              .to_level_ = to_float(s.to_level_),
-              .osm_way_ = s.way_ == osr::way_idx_t ::invalid()
-                              ? std::nullopt
-                              : std::optional{static_cast<std::int64_t>(
-                                    to_idx(w.way_osm_idx_[s.way_]))},
-              .polyline_ = {encode_polyline<7>(s.polyline_),
-                            static_cast<std::int64_t>(s.polyline_.size())},
-          };
-        });
-
-    auto concat = geo::polyline{};
-    for (auto const& p : path->segments_) {
-      utl::concat(concat, p.polyline_);
+    // Segments are simplified one by one to keep their first and last
+    // point. The level ranges refer to points of the concatenation.
+    auto concat = std::pmr::vector<geo::latlng>{mr};
+    auto levels = std::vector<api::LevelRange>{};
+    levels.reserve(path->segments_.size());
+    for (auto const& s : path->segments_) {
+      auto const from = concat.size();
+      if (geometry_tolerance <= 0.0) {
+        utl::concat(concat, s.polyline_);
+      } else {
+        utl::concat(concat, simplify(s.polyline_, geometry_tolerance, mr));
+      }
+      if (concat.size() == from) {
+        continue;
+      }
+      levels.push_back(api::LevelRange{
+          .from_level_ = to_float(s.from_level_),
+          .to_level_ = to_float(s.to_level_),
+          .osm_way_ = s.way_ == osr::way_idx_t ::invalid()
+                          ? std::nullopt
+                          : std::optional{static_cast<std::int64_t>(
+                                to_idx(w.way_osm_idx_[s.way_]))},
+          .from_index_ = static_cast<std::int64_t>(from),
+          .to_index_ = static_cast<std::int64_t>(concat.size() - 1U)});
     }
     leg.distance_ = path->dist_;
-    leg.legGeometry_.points_ = encode_polyline<7>(concat);
-    leg.legGeometry_.length_ = static_cast<std::int64_t>(concat.size());
+    leg.legGeometry_ = to_encoded_polyline(concat, 0.0, geometry_precision, mr);
+    leg.legGeometryLevels_ = std::move(levels);
   };
 
   auto itinerary = api::Itinerary{
@@ -209,14 +252,15 @@ api::Itinerary journey_to_response(
               auto const agency = enter_stop.get_provider();
 
               auto& leg = write_leg(api::ModeEnum::TRANSIT);
-              leg.source_ = fmt::format("{}", fmt::streamed(fr.dbg()));
+              if (debug) {
+                leg.source_ = fmt::format("{}", fmt::streamed(fr.dbg()));
+              }
               leg.headsign_ = enter_stop.direction();
               leg.routeColor_ = to_str(color.color_);
               leg.routeTextColor_ = to_str(color.text_color_);
               leg.mode_ = to_mode(enter_stop.get_clasz());
               leg.realTime_ = fr.is_rt();
-              leg.tripId_ =
-                  fmt::format("{}_{}", tags.get_tag(fr.id().src_), fr.id().id_);
+              leg.tripId_ = tags.id(fr.id());
               leg.serviceDate_ = get_service_date(tt, t.r_.t_, 0U);
               leg.agencyName_ = agency.long_name_;
               leg.agencyId_ = agency.short_name_;
@@ -225,16 +269,25 @@ api::Itinerary journey_to_response(
                   to_ms(enter_stop.delay(n::event_type::kDep));
               leg.arrivalDelay_ = to_ms(exit_stop.delay(n::event_type::kArr));
 
-              auto polyline = geo::polyline{};
-              for (auto i = t.stop_range_.from_; i < t.stop_range_.to_; ++i) {
-                auto const stop = fr[i];
-                polyline.emplace_back(stop.pos());
+              auto const shape =
+                  shape_store == nullptr || !fr.is_scheduled()
+                      ? std::span<geo::latlng const>{}
+                      : shape_store->get(
+                            tt, enter_stop.get_trip_idx(n::event_type::kDep),
+                            fr.t_.t_idx_, t.stop_range_,
+                            shapes::get_level(geometry_tolerance));
+              if (!shape.empty()) {
+                leg.legGeometry_ =
+                    to_encoded_polyline(shape, 0.0, geometry_precision, mr);
+              } else {
+                auto polyline = std::pmr::vector<geo::latlng>{mr};
+                for (auto i = t.stop_range_.from_; i < t.stop_range_.to_;
+                     ++i) {
+                  polyline.emplace_back(fr[i].pos());
+                }
+                leg.legGeometry_ =
+                    to_encoded_polyline(polyline, 0.0, geometry_precision, mr);
               }
-              leg.legGeometry_.points_ = geo::encode_polyline<7>(polyline);
-              leg.legGeometry_.length_ =
-                  static_cast<std::int64_t>(polyline.size());
-
-              leg.intermediateStops_ = std::vector<api::Place>{};
 
               leg.from_.departureDelay_ = leg.departureDelay_ =
                   to_ms(fr[t.stop_range_.from_].delay(n::event_type::kDep));
@@ -245,14 +298,30 @@ api::Itinerary journey_to_response(
                   static_cast<n::stop_idx_t>(t.stop_range_.from_ + 1U);
               auto const last =
                   static_cast<n::stop_idx_t>(t.stop_range_.to_ - 1U);
-              for (auto i = first; i < last; ++i) {
-                auto const stop = fr[i];
-                auto& p = leg.intermediateStops_->emplace_back(
-                    to_place(tt, tags, stop.get_location_idx(), start, dest));
-                p.departure_ = to_ms(stop.time(n::event_type::kDep));
-                p.departureDelay_ = to_ms(stop.delay(n::event_type::kDep));
-                p.arrival_ = to_ms(stop.time(n::event_type::kArr));
-                p.arrivalDelay_ = to_ms(stop.delay(n::event_type::kArr));
+              auto const set_times = [](auto& p, n::rt::run_stop const& s) {
+                p.departure_ = to_ms(s.time(n::event_type::kDep));
+                p.departureDelay_ = to_ms(s.delay(n::event_type::kDep));
+                p.arrival_ = to_ms(s.time(n::event_type::kArr));
+                p.arrivalDelay_ = to_ms(s.delay(n::event_type::kArr));
+              };
+              if (places != nullptr) {
+                leg.intermediateStopRefs_ = std::vector<api::PlaceRef>{};
+                for (auto i = first; i < last; ++i) {
+                  auto const stop = fr[i];
+                  set_times(leg.intermediateStopRefs_->emplace_back(
+                                api::PlaceRef{.placeIdx_ = places->get(
+                                                  tt, tags,
+                                                  stop.get_location_idx())}),
+                            stop);
+                }
+              } else {
+                leg.intermediateStops_ = std::vector<api::Place>{};
+                for (auto i = first; i < last; ++i) {
+                  auto const stop = fr[i];
+                  set_times(leg.intermediateStops_->emplace_back(to_place(
+                                tt, tags, stop.get_location_idx(), start, dest)),
+                            stop);
+                }
               }
             },
             [&](n::footpath) {
@@ -0,0 +1,121 @@
+#include "motis/json_writer.h"
+
+#include <charconv>
+#include <cmath>
+
+#include "boost/json/serialize.hpp"
+
+namespace motis {
+
+void json_writer::separator() {
+  if (!first_) {
+    out_.push_back(',');
+  }
+  first_ = false;
+}
+
+void json_writer::begin_object() {
+  separator();
+  out_.push_back('{');
+  first_ = true;
+}
+
+void json_writer::end_object() {
+  out_.push_back('}');
+  first_ = false;
+}
+
+void json_writer::begin_array() {
+  separator();
+  out_.push_back('[');
+  first_ = true;
+}
+
+void json_writer::end_array() {
+  out_.push_back(']');
+  first_ = false;
+}
+
+void json_writer::key(std::string_view k) {
+  value(k);
+  out_.push_back(':');
+  first_ = true;
+}
+
+void json_writer::null() {
+  separator();
+  out_.append("null");
+}
+
+void json_writer::value(bool const x) {
+  separator();
+  out_.append(x ? "true" : "false");
+}
+
+void json_writer::value(std::int64_t const x) {
+  separator();
+  char buf[24];
+  auto const res = std::to_chars(std::begin(buf), std::end(buf), x);
+  out_.append(buf, res.ptr);
+}
+
+void json_writer::value(std::uint64_t const x) {
+  separator();
+  char buf[24];
+  auto const res = std::to_chars(std::begin(buf), std::end(buf), x);
+  out_.append(buf, res.ptr);
+}
+
+void json_writer::value(double const x) {
+  if (!std::isfinite(x)) {
+    null();
+    return;
+  }
+  separator();
+  char buf[32];
+  auto const res = std::to_chars(std::begin(buf), std::end(buf), x);
+  auto const str = std::string_view{buf, res.ptr};
+  out_.append(str);
+  if (str.find_first_of(".e") == std::string_view::npos) {
+    out_.append(".0");  // stays a floating point number for JSON parsers
+  }
+}
+
+void json_writer::value(std::string_view s) {
+  constexpr auto const kHex = std::string_view{"0123456789abcdef"};
+
+  separator();
+  out_.push_back('"');
+  auto clean_from = std::size_t{0U};
+  for (auto i = std::size_t{0U}; i != s.size(); ++i) {
+    auto const c = static_cast<unsigned char>(s[i]);
+    if (c >= 0x20U && c != '"' && c != '\\') {
+      continue;
+    }
+
+    out_.append(s.substr(clean_from, i - clean_from));
+    clean_from = i + 1U;
+    switch (c) {
+      case '"': out_.append("\\\""); break;
+      case '\\': out_.append("\\\\"); break;
+      case '\n': out_.append("\\n"); break;
+      case '\r': out_.append("\\r"); break;
+      case '\t': out_.append("\\t"); break;
+      case '\b': out_.append("\\b"); break;
+      case '\f': out_.append("\\f"); break;
+      default:
+        out_.append("\\u00");
+        out_.push_back(kHex[c >> 4U]);
+        out_.push_back(kHex[c & 0xFU]);
+    }
+  }
+  out_.append(s.substr(clean_from));
+  out_.push_back('"');
+}
+
+void json_writer::value(boost::json::value const& v) {
+  separator();
+  out_.append(boost::json::serialize(v));
+}
+
+}  // namespace motis
\ No newline at end of file
@@ -1,12 +1,26 @@
 #include "motis/match_platforms.h"
 
+#include <span>
+#include <string>
+
+#include "fmt/ranges.h"
+
+#include "utl/erase_duplicates.h"
 #include "utl/helpers/algorithm.h"
 #include "utl/parallel_for.h"
 #include "utl/parser/arg_parser.h"
+#include "utl/zip.h"
+
+#include "nigiri/timetable.h"
 
 #include "osr/geojson.h"
+#include "osr/platforms.h"
+#include "osr/ways.h"
 
-#include "motis/location_routes.h"
+#include "motis/constants.h"
+#include "motis/geo_kernels.h"
+#include "motis/parallel_for.h"
+#include "motis/tag_lookup.h"
 
 namespace n = nigiri;
 
@@ -33,18 +47,18 @@ void for_each_number(std::string_view x, Fn&& fn) {
   }
 }
 
-bool has_number_match(std::string_view a, std::string_view b) {
-  auto match = false;
-  for_each_number(a, [&](unsigned const x) {
-    for_each_number(b, [&](unsigned const y) { match = (x == y); });
-  });
-  return match;
+// Two names have a number match if their last numbers are equal.
+std::optional<unsigned> get_last_number(std::string_view x) {
+  auto last = std::optional<unsigned>{};
+  for_each_number(x, [&](unsigned const number) { last = number; });
+  return last;
 }
 
 template <typename Collection>
-bool has_number_match(Collection&& a, std::string_view b) {
-  return std::any_of(a.begin(), a.end(),
-                     [&](auto&& x) { return has_number_match(x.view(), b); });
+bool has_number_match(Collection&& numbers, std::optional<unsigned> const x) {
+  return x.has_value() &&
+         std::any_of(numbers.begin(), numbers.end(),
+                     [&](unsigned const y) { return y == *x; });
 }
 
 template <typename Collection>
@@ -72,30 +86,45 @@ std::optional<std::string_view> get_track(std::string_view s) {
   return s;
 }
 
+// Sorted, deduplicated names of all transports stopping at `l`.
+std::vector<std::string_view> get_route_names(n::timetable const& tt,
+                                              n::location_idx_t const l) {
+  auto names = std::vector<std::string_view>{};
+  for (auto const r : tt.location_routes_[l]) {
+    for (auto const t : tt.route_transport_ranges_[r]) {
+      names.emplace_back(tt.transport_name(t));
+    }
+  }
+  utl::erase_duplicates(names);
+  return names;
+}
+
 template <typename Collection>
-double get_routes_bonus(n::timetable const& tt,
-                        n::location_idx_t const l,
+double get_routes_bonus(std::span<std::string_view const> route_names,
                         Collection&& names) {
+  auto const is_route = [&](std::string_view x) {
+    return std::binary_search(begin(route_names), end(route_names), x);
+  };
+
   auto matches = 0U;
-  for (auto const& r : get_location_routes(tt, l)) {
-    for (auto const& x : names) {
-      if (r == x.view()) {
+  for (auto const& x : names) {
+    if (is_route(x.view())) {
+      ++matches;
+    }
+
+    utl::for_each_token(x.view(), ' ', [&](auto&& token) {
+      if (is_route(token.view())) {
         ++matches;
       }
-
-      utl::for_each_token(x.view(), ' ', [&](auto&& token) {
-        if (r == token.view()) {
-          ++matches;
-        }
-      });
-    }
+    });
   }
 
   return matches * 20U;
 }
 
-template <typename Collection>
-double get_match_bonus(Collection&& names,
+template <typename Names, typename Numbers>
+double get_match_bonus(Names&& names,
+                       Numbers&& numbers,
                        std::string_view ref,
                        std::string_view name) {
   auto bonus = 0U;
@@ -103,11 +132,11 @@ double get_match_bonus(Collection&& names,
   if (has_exact_match(names, ref)) {
     bonus += 200.0 - size;
   }
-  if (has_number_match(names, name)) {
+  if (has_number_match(numbers, get_last_number(name))) {
     bonus += 140.0 - size;
   }
   if (auto const track = get_track(ref);
-      track.has_value() && has_number_match(names, *track)) {
+      track.has_value() && has_number_match(numbers, get_last_number(*track))) {
     bonus += 60.0 - size;
   }
   if (has_exact_match(names, name)) {
@@ -158,75 +187,231 @@ std::optional<geo::latlng> get_platform_center(osr::platforms const& pl,
 
   auto const center = c.get_center();
   auto closest = geo::latlng{};
-  auto update_closest = [&, dist = std::numeric_limits<double>::max()](
-                            geo::latlng const& candidate) mutable {
-    auto const candidate_dist = geo::distance(candidate, center);
-    if (candidate_dist < dist) {
+  auto closest_dist = std::numeric_limits<double>::max();
+  auto polyline = std::vector<geo::latlng>{};
+  for (auto const p : pl.platform_ref_[x]) {
+    polyline.clear();
+    std::visit(utl::overloaded{[&](osr::node_idx_t const node) {
+                                 polyline.emplace_back(
+                                     pl.get_node_pos(node).as_latlng());
+                               },
+                               [&](osr::way_idx_t const way) {
+                                 for (auto const& pos : w.way_polylines_[way]) {
+                                   polyline.emplace_back(geo::latlng(pos));
+                                 }
+                               }},
+               osr::to_ref(p));
+    if (polyline.empty()) {
+      continue;
+    }
+
+    auto const [candidate, dist] = closest_on_polyline(center, polyline);
+    if (dist < closest_dist) {
       closest = candidate;
-      dist = candidate_dist;
+      closest_dist = dist;
     }
-  };
-  for (auto const p : pl.platform_ref_[x]) {
-    std::visit(
-        utl::overloaded{
-            [&](osr::node_idx_t const node) {
-              update_closest(pl.get_node_pos(node).as_latlng());
-            },
-            [&](osr::way_idx_t const way) {
-              for (auto const [a, b] : utl::pairwise(w.way_polylines_[way])) {
-                update_closest(geo::closest_on_segment(center, a, b));
-              }
-            }},
-        osr::to_ref(p));
   }
   return closest;
 }
 
-vector_map<n::location_idx_t, osr::platform_idx_t> get_matches(
-    nigiri::timetable const& tt, osr::platforms const& pl, osr::ways const& w) {
+std::vector<osr::platform_idx_t> get_all_platforms(osr::platforms const& pl) {
+  auto all = std::vector<osr::platform_idx_t>{};
+  all.reserve(pl.platform_ref_.size());
+  for (auto i = 0U; i != pl.platform_ref_.size(); ++i) {
+    all.emplace_back(i);
+  }
+  return all;
+}
+
+platform_centers_t get_platform_centers(osr::platforms const& pl,
+                                        osr::ways const& w) {
+  auto centers = platform_centers_t{};
+  centers.resize(pl.platform_ref_.size());
+  utl::parallel_for_run(pl.platform_ref_.size(), [&](auto const i) {
+    auto const x = osr::platform_idx_t{i};
+    centers[x] = get_platform_center(pl, w, x).value_or(geo::latlng{});
+  });
+  return centers;
+}
+
+platform_features::platform_features(osr::platforms const& pl,
+                                     platform_centers_t const& centers)
+    : platform_features{pl, centers, get_all_platforms(pl)} {}
+
+platform_features::platform_features(
+    osr::platforms const& pl,
+    platform_centers_t const& centers,
+    std::vector<osr::platform_idx_t> const& platforms)
+    : centers_{centers} {
+  auto const n_platforms = pl.platform_ref_.size();
+  auto numbers = std::vector<unsigned>{};
+  auto next = begin(platforms);
+  for (auto i = 0U; i != n_platforms; ++i) {
+    auto const x = osr::platform_idx_t{i};
+    numbers.clear();
+    if (next != end(platforms) && *next == x) {
+      ++next;
+      for (auto const& name : pl.platform_names_[x]) {
+        if (auto const number = get_last_number(name.view());
+            number.has_value()) {
+          numbers.emplace_back(*number);
+        }
+      }
+    }
+    numbers_.emplace_back(numbers);
+  }
+}
+
+platform_matches_t get_matches(n::timetable const& tt,
+                               osr::platforms const& pl,
+                               osr::ways const& w,
+                               platform_centers_t const& centers) {
+  auto const features = platform_features{pl, centers};
+  auto const costs = utl::to_vec(tt.location_routes_, [](auto&& routes) {
+    return static_cast<std::uint32_t>(routes.size());
+  });
   auto m = n::vector_map<n::location_idx_t, osr::platform_idx_t>{};
   m.resize(tt.n_locations());
+  parallel_for_by_cost(costs, [&](std::size_t const i) {
+    auto const l = n::location_idx_t{static_cast<std::uint32_t>(i)};
+    m[l] = get_match(tt, pl, w, features, l);
+  });
+  return m;
+}
+
+location_route_names_t get_location_route_names(n::timetable const& tt) {
+  auto names = std::vector<std::string>(tt.n_locations());
+  utl::parallel_for_run(tt.n_locations(), [&](auto const i) {
+    auto const l = n::location_idx_t{i};
+    names[i] = fmt::format("{}", fmt::join(get_route_names(tt, l), ", "));
+  });
+
+  auto ret = location_route_names_t{};
+  for (auto const& x : names) {
+    ret.emplace_back(x);
+  }
+  return ret;
+}
+
+match_fingerprints_t get_match_fingerprints(n::timetable const& tt,
+                                            tag_lookup const& tags) {
+  auto fingerprints = match_fingerprints_t{};
+  fingerprints.resize(tt.n_locations());
   utl::parallel_for_run(tt.n_locations(), [&](auto const i) {
     auto const l = n::location_idx_t{i};
-    m[l] = get_match(tt, pl, w, l);
+    auto const pos = tt.locations_.coordinates_[l];
+    auto h = cista::hash(tags.id(l));
+    h = cista::hash(tt.locations_.names_[l].view(), h);
+    h = cista::build_hash(h, pos.lat_, pos.lng_);
+    for (auto const r : get_route_names(tt, l)) {
+      h = cista::hash(r, h);
+    }
+    fingerprints[l] = h;
+  });
+  return fingerprints;
+}
+
+platform_matches_t update_matches(n::timetable const& tt,
+                                  osr::platforms const& pl,
+                                  osr::ways const& w,
+                                  platform_centers_t const& centers,
+                                  match_fingerprints_t const& fingerprints,
+                                  match_fingerprints_t const& prev_fingerprints,
+                                  platform_matches_t const& prev_matches) {
+  auto prev = hash_map<cista::hash_t, osr::platform_idx_t>{};
+  for (auto const [fingerprint, match] :
+       utl::zip(prev_fingerprints, prev_matches)) {
+    prev.emplace(fingerprint, match);
+  }
+
+  auto m = platform_matches_t{};
+  m.resize(tt.n_locations());
+  auto todo = std::vector<n::location_idx_t>{};
+  auto candidates = std::vector<osr::platform_idx_t>{};
+  for (auto i = 0U; i != tt.n_locations(); ++i) {
+    auto const l = n::location_idx_t{i};
+    if (auto const it = prev.find(fingerprints[l]); it != end(prev)) {
+      m[l] = it->second;
+      continue;
+    }
+    todo.emplace_back(l);
+    pl.find(tt.locations_.coordinates_[l],
+            [&](osr::platform_idx_t const x) { candidates.emplace_back(x); });
+  }
+  utl::erase_duplicates(candidates);
+
+  auto const features = platform_features{pl, centers, candidates};
+  auto const costs = utl::to_vec(todo, [&](n::location_idx_t const l) {
+    return static_cast<std::uint32_t>(tt.location_routes_[l].size());
+  });
+  parallel_for_by_cost(costs, [&](std::size_t const i) {
+    m[todo[i]] = get_match(tt, pl, w, features, todo[i]);
   });
   return m;
 }
 
+location_positions_t get_location_positions(n::timetable const& tt,
+                                            osr::platforms const& pl,
+                                            osr::ways const& w,
+                                            platform_centers_t const& centers,
+                                            platform_matches_t const& matches) {
+  auto positions = location_positions_t{};
+  positions.resize(tt.n_locations());
+  utl::parallel_for_run(tt.n_locations(), [&](auto const i) {
+    auto const l = n::location_idx_t{i};
+    auto pos = tt.locations_.coordinates_[l];
+    auto lvl = osr::to_level(0.0F);
+    if (matches[l] != osr::platform_idx_t::invalid()) {
+      auto const center = centers[matches[l]];
+      if (geo::distance(center, pos) < kMaxAdjust) {
+        pos = center;
+      }
+      lvl = pl.get_level(w, matches[l]);
+    }
+    positions[l] = {pos, lvl};
+  });
+  return positions;
+}
+
 osr::platform_idx_t get_match(n::timetable const& tt,
                               osr::platforms const& pl,
                               osr::ways const& w,
+                              platform_features const& features,
                               n::location_idx_t const l) {
   auto const ref = tt.locations_.coordinates_[l];
   auto best = osr::platform_idx_t::invalid();
   auto best_score = std::numeric_limits<double>::max();
 
+  auto candidates = std::vector<osr::platform_idx_t>{};
+  auto centers = std::vector<geo::latlng>{};
   pl.find(ref, [&](osr::platform_idx_t const x) {
-    auto const center = get_platform_center(pl, w, x);
-    if (!center.has_value()) {
-      return;
-    }
+    candidates.emplace_back(x);
+    centers.emplace_back(features.centers_[x]);
+  });
+  if (candidates.empty()) {
+    return best;
+  }
+
+  auto distances = std::vector<double>(centers.size());
+  approx_distances(ref, centers, distances);
 
-    auto const dist = geo::distance(*center, ref);
-    auto const match_bonus =
-        get_match_bonus(pl.platform_names_[x], tt.locations_.ids_[l].view(),
-                        tt.locations_.names_[l].view());
+  auto const route_names = get_route_names(tt, l);
+  for (auto const [x, dist] : utl::zip(candidates, distances)) {
+    auto const match_bonus = get_match_bonus(
+        pl.platform_names_[x], features.numbers_[x],
+        tt.locations_.ids_[l].view(), tt.locations_.names_[l].view());
     auto const lvl = pl.get_level(w, x);
     auto const lvl_bonus =
         lvl != osr::level_t::invalid() && osr::to_float(lvl) != 0.0F ? 5 : 0;
     auto const way_bonus = osr::is_way(pl.platform_ref_[x].front()) ? 20 : 0;
-    auto const routes_bonus = get_routes_bonus(tt, l, pl.platform_names_[x]);
+    auto const routes_bonus =
+        get_routes_bonus(route_names, pl.platform_names_[x]);
     auto const score =
         dist - match_bonus - way_bonus - lvl_bonus - routes_bonus;
     if (score < best_score) {
       best = x;
       best_score = score;
     }
-  });
-
-  if (best != osr::platform_idx_t::invalid()) {
-    get_match_bonus(pl.platform_names_[best], tt.locations_.ids_[l].view(),
-                    tt.locations_.names_[l].view());
   }
 
   return best;
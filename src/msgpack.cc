@@ -0,0 +1,123 @@
+#include "motis/msgpack.h"
+
+#include <bit>
+#include <cstdint>
+
+#include "boost/json.hpp"
+
+namespace motis::msgpack {
+
+namespace {
+
+template <typename T>
+void write_be(std::string& out, std::uint8_t const type, T const x) {
+  out.push_back(static_cast<char>(type));
+  auto v = std::bit_cast<std::make_unsigned_t<T>>(x);
+  for (auto i = static_cast<int>(sizeof(T)) - 1; i >= 0; --i) {
+    out.push_back(static_cast<char>((v >> (i * 8)) & 0xFFU));
+  }
+}
+
+void write_header(std::string& out,
+                  std::size_t const n,
+                  std::uint8_t const fix_type,
+                  std::size_t const fix_max,
+                  std::uint8_t const type16,
+                  std::uint8_t const type32) {
+  if (n < fix_max) {
+    out.push_back(static_cast<char>(fix_type | n));
+  } else if (n <= 0xFFFFU) {
+    write_be(out, type16, static_cast<std::uint16_t>(n));
+  } else {
+    write_be(out, type32, static_cast<std::uint32_t>(n));
+  }
+}
+
+}  // namespace
+
+void write_nil(std::string& out) { out.push_back(static_cast<char>(0xC0)); }
+
+void write_bool(std::string& out, bool const x) {
+  out.push_back(static_cast<char>(x ? 0xC3 : 0xC2));
+}
+
+void write_int(std::string& out, std::int64_t const x) {
+  if (x >= 0) {
+    write_uint(out, static_cast<std::uint64_t>(x));
+  } else if (x >= -32) {
+    out.push_back(static_cast<char>(x));
+  } else if (x >= INT8_MIN) {
+    write_be(out, 0xD0, static_cast<std::int8_t>(x));
+  } else if (x >= INT16_MIN) {
+    write_be(out, 0xD1, static_cast<std::int16_t>(x));
+  } else if (x >= INT32_MIN) {
+    write_be(out, 0xD2, static_cast<std::int32_t>(x));
+  } else {
+    write_be(out, 0xD3, x);
+  }
+}
+
+void write_uint(std::string& out, std::uint64_t const x) {
+  if (x < 128U) {
+    out.push_back(static_cast<char>(x));
+  } else if (x <= UINT8_MAX) {
+    write_be(out, 0xCC, static_cast<std::uint8_t>(x));
+  } else if (x <= UINT16_MAX) {
+    write_be(out, 0xCD, static_cast<std::uint16_t>(x));
+  } else if (x <= UINT32_MAX) {
+    write_be(out, 0xCE, static_cast<std::uint32_t>(x));
+  } else {
+    write_be(out, 0xCF, x);
+  }
+}
+
+void write_double(std::string& out, double const x) {
+  write_be(out, 0xCB, std::bit_cast<std::uint64_t>(x));
+}
+
+void write_str(std::string& out, std::string_view s) {
+  if (s.size() < 32U) {
+    out.push_back(static_cast<char>(0xA0U | s.size()));
+  } else if (s.size() <= UINT8_MAX) {
+    write_be(out, 0xD9, static_cast<std::uint8_t>(s.size()));
+  } else if (s.size() <= UINT16_MAX) {
+    write_be(out, 0xDA, static_cast<std::uint16_t>(s.size()));
+  } else {
+    write_be(out, 0xDB, static_cast<std::uint32_t>(s.size()));
+  }
+  out.append(s);
+}
+
+void write_array_header(std::string& out, std::size_t const n) {
+  write_header(out, n, 0x90, 16U, 0xDC, 0xDD);
+}
+
+void write_map_header(std::string& out, std::size_t const n) {
+  write_header(out, n, 0x80, 16U, 0xDE, 0xDF);
+}
+
+void write_json(std::string& out, boost::json::value const& v) {
+  switch (v.kind()) {
+    case boost::json::kind::null: write_nil(out); break;
+    case boost::json::kind::bool_: write_bool(out, v.get_bool()); break;
+    case boost::json::kind::int64: write_int(out, v.get_int64()); break;
+    case boost::json::kind::uint64: write_uint(out, v.get_uint64()); break;
+    case boost::json::kind::double_: write_double(out, v.get_double()); break;
+    case boost::json::kind::string: write_str(out, v.get_string()); break;
+    case boost::json::kind::array:
+      write_array_header(out, v.get_array().size());
+      for (auto const& x : v.get_array()) {
+        write_json(out, x);
+      }
+      break;
+    case boost::json::kind::object:
+      write_map_header(out, v.get_object().size());
+      for (auto const& [key, x] : v.get_object()) {
+        write_str(out, key);
+        write_json(out, x);
+      }
+      break;
+  }
+}
+
+}  // namespace motis::msgpack
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "motis/polyline.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+#include "utl/verify.h"
+
+namespace motis {
+
+namespace {
+
+constexpr auto const kMetersPerDegree =
+    6378137.0 * std::numbers::pi / 180.0;
+
+// Distance [meters] of `p` to the segment `a`-`b` using an equirectangular
+// projection around `a` which is precise enough for simplification.
+double segment_distance(geo::latlng const& p,
+                        geo::latlng const& a,
+                        geo::latlng const& b) {
+  auto const scale = std::cos(a.lat_ * std::numbers::pi / 180.0);
+  auto const x = [&](geo::latlng const& q) {
+    return (q.lng_ - a.lng_) * scale * kMetersPerDegree;
+  };
+  auto const y = [&](geo::latlng const& q) {
+    return (q.lat_ - a.lat_) * kMetersPerDegree;
+  };
+
+  auto const bx = x(b), by = y(b), px = x(p), py = y(p);
+  auto const len_sq = bx * bx + by * by;
+  auto const t =
+      len_sq == 0.0 ? 0.0 : std::clamp((px * bx + py * by) / len_sq, 0.0, 1.0);
+  return std::hypot(px - t * bx, py - t * by);
+}
+
+template <typename Vec>
+void simplify(std::span<geo::latlng const> line,
+              double const tolerance,
+              Vec& out,
+              std::pmr::memory_resource* mr) {
+  if (line.size() <= 2U || tolerance <= 0.0) {
+    out.insert(end(out), begin(line), end(line));
+    return;
+  }
+
+  auto keep = std::pmr::vector<bool>(line.size(), false, mr);
+  keep.front() = keep.back() = true;
+
+  auto stack = std::pmr::vector<std::pair<std::size_t, std::size_t>>{mr};
+  stack.emplace_back(0U, line.size() - 1U);
+  while (!stack.empty()) {
+    auto const [from, to] = stack.back();
+    stack.pop_back();
+
+    auto max_dist = 0.0;
+    auto max_idx = from;
+    for (auto i = from + 1U; i < to; ++i) {
+      auto const dist = segment_distance(line[i], line[from], line[to]);
+      if (dist > max_dist) {
+        max_dist = dist;
+        max_idx = i;
+      }
+    }
+
+    if (max_dist > tolerance) {
+      keep[max_idx] = true;
+      stack.emplace_back(from, max_idx);
+      stack.emplace_back(max_idx, to);
+    }
+  }
+
+  for (auto i = 0U; i != line.size(); ++i) {
+    if (keep[i]) {
+      out.push_back(line[i]);
+    }
+  }
+}
+
+}  // namespace
+
+void simplify(std::span<geo::latlng const> line,
+              double const tolerance,
+              std::vector<geo::latlng>& out) {
+  simplify(line, tolerance, out, std::pmr::get_default_resource());
+}
+
+std::vector<geo::latlng> simplify(std::span<geo::latlng const> line,
+                                  double const tolerance) {
+  auto out = std::vector<geo::latlng>{};
+  simplify(line, tolerance, out);
+  return out;
+}
+
+std::pmr::vector<geo::latlng> simplify(std::span<geo::latlng const> line,
+                                       double const tolerance,
+                                       std::pmr::memory_resource* mr) {
+  auto out = std::pmr::vector<geo::latlng>{mr};
+  simplify(line, tolerance, out, mr);
+  return out;
+}
+
+unsigned to_polyline_precision(std::int64_t const precision) {
+  utl::verify(precision >= 1 && precision <= 7,
+              "polyline precision {} not in [1, 7]", precision);
+  return static_cast<unsigned>(precision);
+}
+
+std::string encode_polyline(std::span<geo::latlng const> line,
+                            unsigned const precision) {
+  // 64bit zig-zag value in 5bit chunks
+  constexpr auto const kMaxChunks = 13U;
+
+  auto const factor = std::pow(10.0, precision);
+
+  // Writes into a buffer sized for the worst case: no per-byte capacity
+  // checks, the number of chunks is known upfront from the bit width.
+  auto const encode = [](char* out, std::int64_t const delta) {
+    auto const v =
+        static_cast<std::uint64_t>(delta < 0 ? ~(delta << 1) : delta << 1);
+    auto const n_chunks =
+        std::max(1U, static_cast<unsigned>(std::bit_width(v) + 4U) / 5U);
+    for (auto i = 0U; i != n_chunks; ++i) {
+      auto const continuation = i + 1U != n_chunks ? 0x20U : 0U;
+      out[i] =
+          static_cast<char>(((v >> (5U * i)) & 0x1FU) + continuation + 63U);
+    }
+    return n_chunks;
+  };
+
+  auto out = std::string{};
+  out.resize_and_overwrite(
+      line.size() * 2U * kMaxChunks, [&](char* buf, std::size_t) {
+        auto size = std::size_t{0U};
+        auto prev_lat = std::int64_t{0}, prev_lng = std::int64_t{0};
+        for (auto const& p : line) {
+          auto const lat =
+              static_cast<std::int64_t>(std::llround(p.lat_ * factor));
+          auto const lng =
+              static_cast<std::int64_t>(std::llround(p.lng_ * factor));
+          size += encode(buf + size, lat - prev_lat);
+          size += encode(buf + size, lng - prev_lng);
+          prev_lat = lat;
+          prev_lng = lng;
+        }
+        return size;
+      });
+  return out;
+}
+
+}  // namespace motis
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "motis/request_arena.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace motis {
+
+namespace {
+
+struct thread_buffer {
+  std::vector<std::byte> buf_;
+  bool in_use_{false};
+};
+
+thread_buffer& get_thread_buffer() {
+  thread_local auto b = thread_buffer{};
+  if (b.buf_.empty()) {
+    b.buf_.resize(request_arena::kInitialArenaSize);
+  }
+  return b;
+}
+
+}  // namespace
+
+void* request_arena::overflow_resource::do_allocate(
+    std::size_t const bytes, std::size_t const alignment) {
+  allocated_ += bytes;
+  return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void request_arena::overflow_resource::do_deallocate(
+    void* p, std::size_t const bytes, std::size_t const alignment) {
+  std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool request_arena::overflow_resource::do_is_equal(
+    std::pmr::memory_resource const& o) const noexcept {
+  return this == &o;
+}
+
+request_arena::request_arena()
+    : owns_thread_buffer_{!get_thread_buffer().in_use_},
+      mono_{owns_thread_buffer_ ? get_thread_buffer().buf_.data() : nullptr,
+            owns_thread_buffer_ ? get_thread_buffer().buf_.size() : 0U,
+            &overflow_} {
+  if (owns_thread_buffer_) {
+    get_thread_buffer().in_use_ = true;
+  }
+}
+
+request_arena::~request_arena() {
+  mono_.release();
+  if (!owns_thread_buffer_) {
+    return;
+  }
+
+  // Grow the buffer so the next request of this size fits.
+  auto& b = get_thread_buffer();
+  if (overflow_.allocated_ != 0U && b.buf_.size() < kMaxArenaSize) {
+    auto const size =
+        std::min(kMaxArenaSize, b.buf_.size() + overflow_.allocated_);
+    b.buf_.resize(size);
+  }
+  b.in_use_ = false;
+}
+
+}  // namespace motis
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "motis/config.h"
 #include "motis/data.h"
 #include "motis/http_req.h"
+#include "motis/itinerary_watch.h"
 #include "motis/tag_lookup.h"
 
 namespace n = nigiri;
@@ -20,7 +21,8 @@ namespace motis {
 awaitable<void> rt_update(config const& c,
                           nigiri::timetable const& tt,
                           tag_lookup const& tags,
-                          std::shared_ptr<rt>& r) {
+                          std::shared_ptr<rt>& r,
+                          itinerary_watch& watch) {
   auto const t = utl::scoped_timer{"rt_update"};
 
   auto const no_hdr = headers_t{};
@@ -65,6 +67,8 @@ awaitable<void> rt_update(config const& c,
 
   r = std::make_shared<rt>(std::move(rtt), std::move(r->e_));
 
+  watch.update(tt, *r->rtt_);
+
   co_return;
 }
 
@@ -0,0 +1,173 @@
+#include "motis/shapes.h"
+
+#include <limits>
+#include <map>
+#include <vector>
+
+#include "utl/pairwise.h"
+#include "utl/timer.h"
+
+#include "nigiri/timetable.h"
+
+#include "motis/polyline.h"
+
+namespace fs = std::filesystem;
+namespace n = nigiri;
+
+namespace motis {
+
+namespace {
+
+// stops further away from the shape than this [meters] are matched
+// to the closest point of the remaining shape
+constexpr auto const kStopMatchDistance = 100.0;
+
+std::span<geo::latlng const> get_source_shape(n::shape_storage_t const& src,
+                                              n::trip_idx_t const trip) {
+  auto const shape = src.get_shape(trip);
+  return {begin(shape), end(shape)};
+}
+
+std::vector<std::uint32_t> match_stops(std::span<geo::latlng const> shape,
+                                       std::vector<geo::latlng> const& stops) {
+  auto offsets = std::vector<std::uint32_t>{};
+  offsets.reserve(stops.size());
+  auto from = 0U;
+  for (auto const& stop : stops) {
+    auto best = from;
+    auto best_dist = std::numeric_limits<double>::max();
+    for (auto i = from; i != shape.size(); ++i) {
+      auto const dist = geo::distance(shape[i], stop);
+      if (dist < best_dist) {
+        best = i;
+        best_dist = dist;
+      } else if (best_dist < kStopMatchDistance &&
+                 dist > best_dist + kStopMatchDistance) {
+        break;
+      }
+    }
+    offsets.push_back(best);
+    from = best;
+  }
+  return offsets;
+}
+
+}  // namespace
+
+shapes::shapes(fs::path p, cista::mmap::protection const mode)
+    : p_{std::move(p)},
+      mode_{mode},
+      trip_shape_{mm("trip_shape_data.bin"), mm("trip_shape_index.bin")},
+      points_{mm("points_data.bin"), mm("points_index.bin")},
+      offsets_{mm("offsets_data.bin"), mm("offsets_index.bin")} {}
+
+cista::mmap shapes::mm(char const* file) {
+  return cista::mmap{(p_ / file).generic_string().c_str(), mode_};
+}
+
+unsigned shapes::get_level(double const tolerance) {
+  auto level = 0U;
+  for (auto i = 0U; i != kNumLevels; ++i) {
+    if (kLevels[i] <= tolerance) {
+      level = i;
+    }
+  }
+  return level;
+}
+
+std::span<geo::latlng const> shapes::get(
+    n::timetable const& tt,
+    n::trip_idx_t const trip,
+    n::transport_idx_t const t,
+    n::interval<n::stop_idx_t> const stops,
+    unsigned const level) const {
+  if (to_idx(trip) >= trip_shape_.size() || stops.size() < 2U) {
+    return {};
+  }
+
+  auto const ranges = tt.trip_transport_ranges_[trip];
+  auto const range_shapes = trip_shape_[trip];
+  for (auto j = 0U; j != range_shapes.size() && j != ranges.size(); ++j) {
+    auto const [t_idx, range] = ranges[j];
+    if (t_idx != t || stops.from_ < range.from_ || stops.to_ > range.to_) {
+      continue;
+    }
+
+    auto const bucket = bucket_idx_t{static_cast<std::uint32_t>(
+        to_idx(range_shapes[j]) * kNumLevels + level)};
+    auto const offsets = offsets_[bucket];
+    auto const points = points_[bucket];
+    if (stops.to_ - range.from_ > offsets.size()) {
+      return {};
+    }
+    auto const from = offsets[stops.from_ - range.from_];
+    auto const to = offsets[stops.to_ - 1U - range.from_];
+    return {points.begin() + from, points.begin() + to + 1U};
+  }
+  return {};
+}
+
+void build_shapes(n::timetable const& tt,
+                  n::shape_storage_t const& src,
+                  fs::path const& p) {
+  auto const timer = utl::scoped_timer{"shapes"};
+
+  auto ec = std::error_code{};
+  fs::create_directories(p, ec);
+
+  auto s = shapes{p, cista::mmap::protection::WRITE};
+  auto shape_indices = std::map<
+      std::pair<geo::latlng const*, std::vector<std::uint32_t>>,
+      shapes::shape_idx_t>{};
+  auto stops = std::vector<geo::latlng>{};
+  auto points = std::vector<geo::latlng>{};
+  auto offsets = std::vector<std::uint32_t>{};
+  auto range_shapes = std::vector<shapes::shape_idx_t>{};
+  for (auto i = 0U; i != tt.trip_transport_ranges_.size(); ++i) {
+    auto const trip = n::trip_idx_t{i};
+    auto const shape = get_source_shape(src, trip);
+    range_shapes.clear();
+    if (shape.size() < 2U) {
+      s.trip_shape_.emplace_back(range_shapes);
+      continue;
+    }
+
+    for (auto const [t, stop_range] : tt.trip_transport_ranges_[trip]) {
+      auto const seq = tt.route_location_seq_[tt.transport_route_[t]];
+      stops.clear();
+      for (auto j = stop_range.from_; j != stop_range.to_; ++j) {
+        stops.push_back(
+            tt.locations_.coordinates_[n::stop{seq[j]}.location_idx()]);
+      }
+
+      auto const [it, inserted] = shape_indices.emplace(
+          std::pair{shape.data(), match_stops(shape, stops)},
+          shapes::shape_idx_t{
+              static_cast<std::uint32_t>(shape_indices.size())});
+      range_shapes.push_back(it->second);
+      if (!inserted) {
+        continue;
+      }
+
+      auto const& stop_offsets = it->first.second;
+      for (auto const tolerance : shapes::kLevels) {
+        points.clear();
+        offsets.clear();
+        points.push_back(shape[stop_offsets.front()]);
+        offsets.push_back(0U);
+        for (auto const [from, to] : utl::pairwise(stop_offsets)) {
+          auto const segment_start = points.size();
+          simplify(shape.subspan(from, to - from + 1U), tolerance, points);
+          points.erase(begin(points) +
+                       static_cast<std::ptrdiff_t>(segment_start));
+          offsets.push_back(static_cast<std::uint32_t>(points.size() - 1U));
+        }
+        s.points_.emplace_back(points);
+        s.offsets_.emplace_back(offsets);
+      }
+    }
+    s.trip_shape_.emplace_back(range_shapes);
+  }
+}
+
+}  // namespace motis
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "motis/tag_lookup.h"
 
+#include <iterator>
+
 #include "fmt/core.h"
 
 #include "cista/io.h"
@@ -36,23 +38,12 @@ std::string_view tag_lookup::get_tag(n::source_idx_t const src) const {
   return src == n::source_idx_t::invalid() ? "" : src_to_tag_.at(src).view();
 }
 
-std::string tag_lookup::id(nigiri::timetable const& tt,
-                           nigiri::location_idx_t const l) const {
-  auto const src = tt.locations_.src_.at(l);
-  auto const id = tt.locations_.ids_.at(l).view();
-  return src == n::source_idx_t::invalid()
-             ? std::string{id}
-             : fmt::format("{}_{}", get_tag(src), id);
+std::string_view tag_lookup::id(nigiri::location_idx_t const l) const {
+  return location_ids_.at(l).view();
 }
 
-std::string tag_lookup::id(nigiri::timetable const& tt,
-                           nigiri::trip_idx_t const t) const {
-  auto const id_idx = tt.trip_ids_[t].front();
-  auto const id = tt.trip_id_strings_[id_idx].view();
-  auto const src = tt.trip_id_src_[id_idx];
-  return src == n::source_idx_t::invalid()
-             ? std::string{id}
-             : fmt::format("{}_{}", get_tag(src), id);
+std::string_view tag_lookup::id(nigiri::trip_idx_t const t) const {
+  return trip_ids_.at(t).view();
 }
 
 std::string tag_lookup::id(nigiri::trip_id const& t) const {
@@ -74,6 +65,32 @@ nigiri::location_idx_t tag_lookup::get(nigiri::timetable const& tt,
   }
 }
 
+void tag_lookup::build_ids(n::timetable const& tt) {
+  auto buf = std::string{};
+  auto const tagged = [&](n::source_idx_t const src,
+                          std::string_view id) -> std::string_view {
+    if (src == n::source_idx_t::invalid()) {
+      return id;
+    }
+    buf.clear();
+    fmt::format_to(std::back_inserter(buf), "{}_{}", get_tag(src), id);
+    return buf;
+  };
+
+  location_ids_.clear();
+  for (auto l = n::location_idx_t{0U}; l != tt.n_locations(); ++l) {
+    location_ids_.emplace_back(
+        tagged(tt.locations_.src_[l], tt.locations_.ids_[l].view()));
+  }
+
+  trip_ids_.clear();
+  for (auto t = n::trip_idx_t{0U}; t != tt.trip_ids_.size(); ++t) {
+    auto const id_idx = tt.trip_ids_[t].front();
+    trip_ids_.emplace_back(
+        tagged(tt.trip_id_src_[id_idx], tt.trip_id_strings_[id_idx].view()));
+  }
+}
+
 void tag_lookup::write(std::filesystem::path const& p) const {
   return cista::write(p, *this);
 }
@@ -0,0 +1,44 @@
+#include "motis/trip_id_index.h"
+
+#include "utl/equal_ranges_linear.h"
+#include "utl/timer.h"
+
+#include "nigiri/timetable.h"
+
+namespace n = nigiri;
+
+namespace motis {
+
+trip_id_index::trip_id_index(n::timetable const& tt) {
+  auto const timer = utl::scoped_timer{"trip id index"};
+
+  auto const key = [&](entry_t const& x) {
+    return std::pair{tt.trip_id_src_[x.first],
+                     tt.trip_id_strings_[x.first].view()};
+  };
+
+  auto const& ids = tt.trip_id_to_idx_;
+  ranges_.reserve(ids.size());
+  utl::equal_ranges_linear(
+      ids, [&](entry_t const& a, entry_t const& b) { return key(a) == key(b); },
+      [&](auto&& from, auto&& to) {
+        ranges_.emplace(
+            key(*from),
+            n::interval{static_cast<std::uint32_t>(from - begin(ids)),
+                        static_cast<std::uint32_t>(to - begin(ids))});
+      });
+}
+
+std::span<trip_id_index::entry_t const> trip_id_index::find(
+    n::timetable const& tt,
+    n::source_idx_t const src,
+    std::string_view trip_id) const {
+  auto const it = ranges_.find(std::pair{src, trip_id});
+  if (it == end(ranges_)) {
+    return {};
+  }
+  auto const& ids = tt.trip_id_to_idx_;
+  return {begin(ids) + it->second.from_, begin(ids) + it->second.to_};
+}
+
+}  // namespace motis
\ No newline at end of file
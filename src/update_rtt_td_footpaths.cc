@@ -2,13 +2,13 @@
 
 #include <map>
 
-#include "utl/parallel_for.h"
+#include "utl/to_vec.h"
 
 #include "osr/routing/route.h"
 
 #include "motis/constants.h"
-#include "motis/get_loc.h"
 #include "motis/max_distance.h"
+#include "motis/parallel_for.h"
 
 namespace n = nigiri;
 using namespace std::chrono_literals;
@@ -76,11 +76,9 @@ std::optional<std::pair<nodes_t, states_t>> get_states_at(
 std::vector<n::td_footpath> get_td_footpaths(
     osr::ways const& w,
     osr::lookup const& l,
-    osr::platforms const& pl,
-    nigiri::timetable const& tt,
     point_rtree<n::location_idx_t> const& loc_rtree,
     elevators const& e,
-    platform_matches_t const& matches,
+    location_positions_t const& positions,
     n::location_idx_t const start_l,
     osr::location const start,
     osr::direction const dir,
@@ -104,8 +102,7 @@ std::vector<n::td_footpath> get_td_footpaths(
                         });
     auto const results = osr::route(
         w, l, profile, start,
-        utl::to_vec(neighbors,
-                    [&](auto&& x) { return get_loc(tt, w, pl, matches, x); }),
+        utl::to_vec(neighbors, [&](auto&& x) { return positions[x]; }),
         static_cast<osr::cost_t>(max.count()), dir,
         get_max_distance(profile, max), &blocked_mem);
 
@@ -128,28 +125,35 @@ std::vector<n::td_footpath> get_td_footpaths(
 void update_rtt_td_footpaths(
     osr::ways const& w,
     osr::lookup const& l,
-    osr::platforms const& pl,
     nigiri::timetable const& tt,
     point_rtree<n::location_idx_t> const& loc_rtree,
     elevators const& e,
-    platform_matches_t const& matches,
+    location_positions_t const& positions,
     hash_set<std::pair<n::location_idx_t, osr::direction>> const& tasks,
     nigiri::rt_timetable const* old_rtt,
     nigiri::rt_timetable& rtt,
     std::chrono::seconds const max) {
   fmt::println("  -> {} routing tasks tasks", tasks.size());
 
+  // Routing time grows with the number of neighbors.
+  auto const costs = utl::to_vec(tasks, [&](auto&& task) {
+    auto n_neighbors = 0U;
+    loc_rtree.in_radius(positions[task.first].pos_, kMaxDistance,
+                        [&](n::location_idx_t) { ++n_neighbors; });
+    return n_neighbors;
+  });
+
   auto in_mutex = std::mutex{}, out_mutex = std::mutex{};
   auto out = std::map<n::location_idx_t, std::vector<n::td_footpath>>{};
   auto in = std::map<n::location_idx_t, std::vector<n::td_footpath>>{};
-  utl::parallel_for_run_threadlocal<osr::bitvec<osr::node_idx_t>>(
-      tasks.size(),
+  parallel_for_by_cost_threadlocal<osr::bitvec<osr::node_idx_t>>(
+      costs,
       [&](osr::bitvec<osr::node_idx_t>& blocked, std::size_t const task_idx) {
         auto const [start, dir] = *(begin(tasks) + task_idx);
-        auto fps =
-            get_td_footpaths(w, l, pl, tt, loc_rtree, e, matches, start,
-                             get_loc(tt, w, pl, matches, start), dir,
-                             osr::search_profile::kWheelchair, max, blocked);
+        auto fps = get_td_footpaths(w, l, loc_rtree, e, positions, start,
+                                    positions[start], dir,
+                                    osr::search_profile::kWheelchair, max,
+                                    blocked);
         {
           auto const lock = std::unique_lock{
               dir == osr::direction::kForward ? out_mutex : in_mutex};
@@ -194,12 +198,11 @@ void update_rtt_td_footpaths(
 
 void update_rtt_td_footpaths(osr::ways const& w,
                              osr::lookup const& l,
-                             osr::platforms const& pl,
                              nigiri::timetable const& tt,
                              point_rtree<n::location_idx_t> const& loc_rtree,
                              elevators const& e,
                              elevator_footpath_map_t const& elevators_in_paths,
-                             platform_matches_t const& matches,
+                             location_positions_t const& positions,
                              nigiri::rt_timetable& rtt,
                              std::chrono::seconds const max) {
   auto tasks = hash_set<std::pair<n::location_idx_t, osr::direction>>{};
@@ -218,7 +221,7 @@ void update_rtt_td_footpaths(osr::ways const& w,
       tasks.emplace(to, osr::direction::kBackward);
     }
   }
-  update_rtt_td_footpaths(w, l, pl, tt, loc_rtree, e, matches, tasks, nullptr,
+  update_rtt_td_footpaths(w, l, tt, loc_rtree, e, positions, tasks, nullptr,
                           rtt, max);
 }
 
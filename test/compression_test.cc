@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+
+#include "boost/beast/zlib/inflate_stream.hpp"
+
+#include "motis/compression.h"
+
+namespace zlib = boost::beast::zlib;
+using namespace motis;
+
+TEST(motis, accepts_gzip) {
+  EXPECT_TRUE(accepts_gzip("gzip"));
+  EXPECT_TRUE(accepts_gzip("deflate, gzip;q=1.0, *;q=0.5"));
+  EXPECT_TRUE(accepts_gzip("br, *"));
+  EXPECT_FALSE(accepts_gzip("gzip;q=0"));
+  EXPECT_FALSE(accepts_gzip("identity"));
+  EXPECT_FALSE(accepts_gzip(""));
+
+  EXPECT_TRUE(accepts_gzip("GZIP"));
+  EXPECT_TRUE(accepts_gzip("br;q=1.0, Gzip;Q=0.8"));
+  EXPECT_TRUE(accepts_gzip("deflate;q=0, x-gzip"));
+  EXPECT_TRUE(accepts_gzip("gzip;q=0, gzip;q=0.5"));
+  EXPECT_FALSE(accepts_gzip("GZIP;q=0"));
+  EXPECT_FALSE(accepts_gzip("gzip;q=0.000, *"));
+  EXPECT_FALSE(accepts_gzip("*;q=0.5, gzip;q=0"));
+  EXPECT_FALSE(accepts_gzip("*;q=0"));
+}
+
+TEST(motis, gzip) {
+  auto in = std::string{};
+  for (auto i = 0U; i != 1000U; ++i) {
+    in += "{\"name\":\"Frankfurt (Main) Hbf\",\"lat\":50.1071,\"lon\":8.6638},";
+  }
+
+  auto const out = gzip(in);
+  ASSERT_GT(out.size(), 18U);
+  EXPECT_LT(out.size(), in.size() / 10U);
+  EXPECT_EQ('\x1F', out[0]);
+  EXPECT_EQ('\x8B', out[1]);
+
+  auto decompressed = std::string(in.size(), '\0');
+  auto is = zlib::inflate_stream{};
+  auto zs = zlib::z_params{};
+  zs.next_in = out.data() + 10U;
+  zs.avail_in = out.size() - 18U;
+  zs.next_out = decompressed.data();
+  zs.avail_out = decompressed.size();
+  auto ec = boost::system::error_code{};
+  is.write(zs, zlib::Flush::sync, ec);
+  EXPECT_EQ(zlib::error::end_of_stream, ec);
+  EXPECT_EQ(in, decompressed);
+}
\ No newline at end of file
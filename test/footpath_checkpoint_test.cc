@@ -0,0 +1,55 @@
+#include "gtest/gtest.h"
+
+#include "motis/footpath_checkpoint.h"
+
+namespace fs = std::filesystem;
+namespace n = nigiri;
+using namespace motis;
+
+TEST(motis, footpath_checkpoint) {
+  auto const p = fs::temp_directory_path() / "motis_footpath_checkpoint_test";
+  fs::remove(p);
+
+  auto footpaths = n::vector_map<n::location_idx_t, std::vector<n::footpath>>{};
+  footpaths.resize(10U);
+  footpaths[n::location_idx_t{3U}] = {
+      n::footpath{n::location_idx_t{7U}, n::duration_t{2}},
+      n::footpath{n::location_idx_t{8U}, n::duration_t{5}}};
+  footpaths[n::location_idx_t{7U}] = {
+      n::footpath{n::location_idx_t{3U}, n::duration_t{2}}};
+  auto const locations = std::vector{
+      n::location_idx_t{3U}, n::location_idx_t{7U}, n::location_idx_t{8U}};
+  auto const elevator_paths = std::vector<footpath_checkpoint::elevator_path>{
+      {osr::node_idx_t{9U}, n::location_idx_t{3U}, n::location_idx_t{7U}}};
+
+  {
+    auto c = footpath_checkpoint{p, 42U};
+    EXPECT_TRUE(c.read().empty());
+    c.add(1U, locations, footpaths, elevator_paths);
+    c.add(0U, {locations.data(), 1U}, footpaths, {});
+  }
+
+  {
+    auto const ranges = footpath_checkpoint{p, 42U}.read();
+    ASSERT_EQ(2U, ranges.size());
+    EXPECT_EQ(1U, ranges[0].profile_);
+    EXPECT_EQ(locations, ranges[0].locations_);
+    ASSERT_EQ(3U, ranges[0].footpaths_.size());
+    EXPECT_EQ(footpaths[n::location_idx_t{3U}], ranges[0].footpaths_[0]);
+    EXPECT_EQ(footpaths[n::location_idx_t{7U}], ranges[0].footpaths_[1]);
+    EXPECT_TRUE(ranges[0].footpaths_[2].empty());
+    ASSERT_EQ(1U, ranges[0].elevator_paths_.size());
+    EXPECT_EQ(osr::node_idx_t{9U}, ranges[0].elevator_paths_[0].node_);
+    EXPECT_EQ(0U, ranges[1].profile_);
+    EXPECT_EQ(1U, ranges[1].locations_.size());
+  }
+
+  // Reading with another key leaves the file as it is.
+  EXPECT_TRUE(footpath_checkpoint::read(p, 43U).empty());
+  EXPECT_EQ(2U, footpath_checkpoint::read(p, 42U).size());
+
+  EXPECT_TRUE(footpath_checkpoint(p, 43U).read().empty());
+  EXPECT_TRUE(footpath_checkpoint::read(p, 42U).empty());
+
+  fs::remove(p);
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <vector>
+
+#include "nigiri/timetable.h"
+
+#include "motis/config.h"
+#include "motis/data.h"
+#include "motis/import.h"
+
+namespace n = nigiri;
+using namespace std::string_view_literals;
+using namespace motis;
+
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon,location_type,parent_station,platform_code
+DA,DA Hbf,49.87260,8.63085,1,,
+DA_3,DA Hbf,49.87355,8.63003,0,DA,3
+DA_10,DA Hbf,49.87336,8.62926,0,DA,10
+FFM,FFM Hbf,50.10701,8.66341,1,,
+FFM_101,FFM Hbf,50.10739,8.66333,0,FFM,101
+FFM_12,FFM Hbf,50.10658,8.66178,0,FFM,12
+de:6412:10:6:1,FFM Hbf U-Bahn,50.107577,8.6638173,0,FFM,U4
+FFM_HAUPT,FFM Hauptwache,50.11403,8.67835,1,,
+FFM_HAUPT_U,Hauptwache U1/U2/U3/U8,50.11385,8.67912,0,FFM_HAUPT,
+FFM_HAUPT_S,FFM Hauptwache S,50.11404,8.67824,0,FFM_HAUPT,
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+S3,DB,S3,,,109
+U4,DB,U4,,,402
+ICE,DB,ICE,,,101
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id
+S3,S1,S3,,
+U4,S1,U4,,
+ICE,S1,ICE,,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+S3,01:15:00,01:15:00,FFM_101,1,0,0
+S3,01:20:00,01:20:00,FFM_HAUPT_S,2,0,0
+U4,01:05:00,01:05:00,de:6412:10:6:1,0,0,0
+U4,01:10:00,01:10:00,FFM_HAUPT_U,1,0,0
+ICE,00:45:00,00:45:00,DA_10,0,0,0
+ICE,00:55:00,00:55:00,FFM_12,1,0,0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+)"sv;
+
+data import_footpaths(std::filesystem::path const& data_path,
+                      unsigned const n_shards) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all(data_path, ec);
+  return import(
+      config{.import_budget_ =
+                 config::import_budget{.footpath_shards_ = n_shards},
+             .osm_ = {"test/resources/test_case.osm.pbf"},
+             .timetable_ =
+                 config::timetable{
+                     .first_day_ = "2019-05-01",
+                     .num_days_ = 2,
+                     .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}},
+             .street_routing_ = true,
+             .osr_footpath_ = true},
+      data_path);
+}
+
+TEST(motis, footpath_shards) {
+  auto const a = import_footpaths("test/data_footpaths", 1U);
+  auto const b = import_footpaths("test/data_footpath_shards", 2U);
+
+  EXPECT_TRUE(
+      std::filesystem::is_regular_file("test/data_footpath_shards/logs/"
+                                       "footpaths-1.txt"));
+
+  auto const to_vec = [](auto&& footpaths) {
+    auto v = std::vector<std::pair<n::location_idx_t, n::duration_t>>{};
+    for (auto const& fp : footpaths) {
+      v.emplace_back(fp.target(), fp.duration());
+    }
+    return v;
+  };
+
+  auto const& x = a.tt_->locations_;
+  auto const& y = b.tt_->locations_;
+  ASSERT_EQ(a.tt_->n_locations(), b.tt_->n_locations());
+  auto n_footpaths = 0U;
+  for (auto const profile : {1U, 2U}) {
+    for (auto l = n::location_idx_t{0U}; l != a.tt_->n_locations(); ++l) {
+      EXPECT_EQ(to_vec(x.footpaths_out_[profile][l]),
+                to_vec(y.footpaths_out_[profile][l]))
+          << "profile=" << profile << ", location=" << to_idx(l);
+      EXPECT_EQ(to_vec(x.footpaths_in_[profile][l]),
+                to_vec(y.footpaths_in_[profile][l]))
+          << "profile=" << profile << ", location=" << to_idx(l);
+      n_footpaths += x.footpaths_out_[profile][l].size();
+    }
+  }
+  EXPECT_NE(0U, n_footpaths);
+}
\ No newline at end of file
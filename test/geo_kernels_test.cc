@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "motis/geo_kernels.h"
+
+using namespace motis;
+
+TEST(motis, approx_distances) {
+  auto const x = geo::latlng{50.1, 8.6};
+  auto points = std::vector<geo::latlng>{};
+  for (auto i = 0U; i != 37U; ++i) {
+    points.push_back({50.1 + 0.001 * i, 8.6 - 0.0007 * i});
+  }
+
+  auto dist = std::vector<double>(points.size());
+  approx_distances(x, points, dist);
+  for (auto i = 0U; i != points.size(); ++i) {
+    auto const exact = geo::distance(x, points[i]);
+    EXPECT_NEAR(exact, dist[i], 0.005 * exact) << geo_kernels_impl();
+  }
+}
+
+TEST(motis, closest_on_polyline) {
+  auto const x = geo::latlng{49.9995, 8.0015};
+  auto const line = std::vector<geo::latlng>{{50.0, 8.0},    {50.0, 8.001},
+                                             {50.0, 8.002},  {50.001, 8.002},
+                                             {50.001, 8.003}, {50.002, 8.003}};
+
+  auto const [closest, dist] = closest_on_polyline(x, line);
+  EXPECT_NEAR(50.0, closest.lat_, 1E-9);
+  EXPECT_NEAR(8.0015, closest.lng_, 1E-9);
+  EXPECT_NEAR(geo::distance(x, closest), dist, 0.1);
+
+  auto const [single, single_dist] =
+      closest_on_polyline(x, std::vector<geo::latlng>{{50.0, 8.0}});
+  EXPECT_EQ((geo::latlng{50.0, 8.0}), single);
+  EXPECT_NEAR(geo::distance(x, single), single_dist, 0.1);
+}
\ No newline at end of file
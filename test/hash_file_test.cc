@@ -0,0 +1,28 @@
+#include "gtest/gtest.h"
+
+#include <fstream>
+
+#include "motis/hash_file.h"
+
+namespace fs = std::filesystem;
+using namespace motis;
+
+TEST(motis, hash_file) {
+  auto const dir = fs::temp_directory_path() / "motis_hash_file_test";
+  fs::remove_all(dir);
+  fs::create_directories(dir / "gtfs");
+  std::ofstream{dir / "gtfs" / "stops.txt"} << "stop_id\n1\n";
+  std::ofstream{dir / "gtfs" / "trips.txt"} << "trip_id\n1\n";
+
+  auto cache = file_hash_cache{};
+  auto const file = hash_file(dir / "gtfs" / "stops.txt", cache);
+  auto const folder = hash_file(dir / "gtfs", cache);
+  EXPECT_EQ(2U, cache.entries_.size());
+  EXPECT_EQ(file, hash_file(dir / "gtfs" / "stops.txt", cache));
+
+  std::ofstream{dir / "gtfs" / "stops.txt"} << "stop_id\n2\n3\n";
+  EXPECT_NE(file, hash_file(dir / "gtfs" / "stops.txt", cache));
+  EXPECT_NE(folder, hash_file(dir / "gtfs", cache));
+
+  fs::remove_all(dir);
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "gtest/gtest.h"
+
+#include "boost/json.hpp"
+
+#include "utl/init_from.h"
+
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/rt/rt_timetable.h"
+#include "nigiri/timetable.h"
+
+#include "gtfsrt/gtfs-realtime.pb.h"
+
+#include "motis/config.h"
+#include "motis/data.h"
+#include "motis/endpoints/trip.h"
+#include "motis/endpoints/watch.h"
+#include "motis/import.h"
+#include "motis/itinerary_watch.h"
+#include "motis/tag_lookup.h"
+
+namespace json = boost::json;
+namespace n = nigiri;
+using namespace std::string_view_literals;
+using namespace motis;
+using namespace date;
+
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon,location_type,parent_station,platform_code
+DA_10,DA Hbf,49.87336,8.62926,0,,10
+LANGEN,Langen,49.99359,8.65677,0,,1
+FFM_12,FFM Hbf,50.10658,8.66178,0,,12
+FFM_HAUPT_S,FFM Hauptwache S,50.11404,8.67824,0,,
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+RB,DB,RB,,,106
+S3,DB,S3,,,109
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id
+RB,S1,RB,,
+S3,S1,S3,,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+RB,10:00:00,10:00:00,DA_10,0,0,0
+RB,10:10:00,10:10:00,LANGEN,1,0,0
+RB,10:20:00,10:20:00,FFM_12,2,0,0
+S3,10:30:00,10:30:00,FFM_12,0,0,0
+S3,10:35:00,10:35:00,FFM_HAUPT_S,1,0,0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+)"sv;
+
+transit_realtime::FeedMessage delay_rb(std::int32_t const delay) {
+  auto msg = transit_realtime::FeedMessage{};
+
+  auto const hdr = msg.mutable_header();
+  hdr->set_gtfs_realtime_version("2.0");
+  hdr->set_incrementality(
+      transit_realtime::FeedHeader_Incrementality_FULL_DATASET);
+  hdr->set_timestamp(1556694000U);  // 2019-05-01 09:00 CEST
+
+  auto const e = msg.add_entity();
+  e->set_id("1");
+  auto const td = e->mutable_trip_update()->mutable_trip();
+  td->set_trip_id("RB");
+  td->set_start_date("20190501");
+
+  auto const stu = e->mutable_trip_update()->add_stop_time_update();
+  stu->set_stop_sequence(2U);
+  stu->mutable_arrival()->set_delay(delay);
+  stu->mutable_departure()->set_delay(delay);
+
+  return msg;
+}
+
+TEST(motis, itinerary_watch) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all("test/data_watch", ec);
+
+  auto d = import(
+      config{.timetable_ =
+                 config::timetable{
+                     .first_day_ = "2019-05-01",
+                     .num_days_ = 2,
+                     .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}}},
+      "test/data_watch", false);
+  d.rt_->rtt_ = std::make_unique<n::rt_timetable>(
+      n::rt::create_rt_timetable(*d.tt_, 2019_y / May / 1));
+  auto const watch = utl::init_from<ep::watch>(d).value();
+
+  auto const added_value = watch(json::parse(R"({
+    "legs": [
+      {"tripId": "test_RB", "date": "2019-05-01",
+       "from": "test_DA_10", "to": "test_FFM_12"},
+      {"tripId": "test_S3", "date": "2019-05-01",
+       "from": "test_FFM_12", "to": "test_FFM_HAUPT_S"}
+    ]
+  })"));
+  auto const& added = added_value.as_object();
+  EXPECT_TRUE(added.at("feasible").as_bool());
+  EXPECT_EQ(0, added.at("legs")
+                   .as_array()
+                   .at(0)
+                   .as_object()
+                   .at("arrivalDelay")
+                   .to_number<int>());
+
+  // RB arrives 15 minutes late: the connection to S3 breaks.
+  n::rt::gtfsrt_update_msg(*d.tt_, *d.rt_->rtt_, n::source_idx_t{0}, "test",
+                           delay_rb(15 * 60));
+  EXPECT_EQ(1U, d.watch_->update(*d.tt_, *d.rt_->rtt_));
+
+  auto const updated_value = watch(json::object{{"id", added.at("id")}});
+  auto const& updated = updated_value.as_object();
+  auto const& rb = updated.at("legs").as_array().at(0).as_object();
+  auto const& transfer =
+      updated.at("transfers").as_array().at(0).as_object();
+  EXPECT_EQ(15 * 60 * 1000, rb.at("arrivalDelay").to_number<int>());
+  EXPECT_TRUE(rb.at("realTime").as_bool());
+  EXPECT_FALSE(transfer.at("feasible").as_bool());
+  EXPECT_FALSE(updated.at("feasible").as_bool());
+  EXPECT_NE(added.at("version"), updated.at("version"));
+}
+
+TEST(motis, itinerary_watch_max_watches) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all("test/data_watch_max", ec);
+
+  auto const d = import(
+      config{.timetable_ =
+                 config::timetable{
+                     .first_day_ = "2019-05-01",
+                     .num_days_ = 2,
+                     .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}}},
+      "test/data_watch_max", false);
+
+  auto const legs = std::vector<itinerary_watch::leg_query>{
+      {.r_ = ep::resolve_run(*d.tt_, *d.trip_ids_, 2019_y / May / 1,
+                             n::source_idx_t{0}, "RB"),
+       .from_ = d.tags_->get(*d.tt_, "test_DA_10"),
+       .to_ = d.tags_->get(*d.tt_, "test_FFM_12")}};
+
+  auto w = itinerary_watch{2U};
+  auto const a = w.add(*d.tt_, nullptr, legs);
+  auto const b = w.add(*d.tt_, nullptr, legs);
+  auto const c = w.add(*d.tt_, nullptr, legs);
+  EXPECT_FALSE(w.get(a).has_value());
+  EXPECT_TRUE(w.get(b).has_value());
+  EXPECT_TRUE(w.get(c).has_value());
+
+  w.remove(b);
+  EXPECT_FALSE(w.get(b).has_value());
+  EXPECT_TRUE(w.get(c).has_value());
+}
+
+TEST(motis, itinerary_watch_no_footpath) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all("test/data_watch_no_footpath", ec);
+
+  auto const d = import(
+      config{.timetable_ =
+                 config::timetable{
+                     .first_day_ = "2019-05-01",
+                     .num_days_ = 2,
+                     .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}}},
+      "test/data_watch_no_footpath", false);
+
+  // Leaves RB in Langen, S3 departs in Frankfurt.
+  auto const run = [&](std::string_view trip) {
+    return ep::resolve_run(*d.tt_, *d.trip_ids_, 2019_y / May / 1,
+                           n::source_idx_t{0}, trip);
+  };
+  auto const stop = [&](std::string_view id) {
+    return d.tags_->get(*d.tt_, id);
+  };
+  auto w = itinerary_watch{};
+  auto const id =
+      w.add(*d.tt_, nullptr,
+            {{.r_ = run("RB"),
+              .from_ = stop("test_DA_10"),
+              .to_ = stop("test_LANGEN")},
+             {.r_ = run("S3"),
+              .from_ = stop("test_FFM_12"),
+              .to_ = stop("test_FFM_HAUPT_S")}});
+
+  auto const x = w.get(id);
+  ASSERT_TRUE(x.has_value());
+  ASSERT_EQ(1U, x->transfers_.size());
+  EXPECT_FALSE(x->transfers_.front().min_duration_.has_value());
+  EXPECT_FALSE(x->transfers_.front().feasible_);
+}
\ No newline at end of file
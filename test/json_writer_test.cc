@@ -0,0 +1,26 @@
+#include "gtest/gtest.h"
+
+#include "boost/json.hpp"
+
+#include "motis-api/motis-api.h"
+#include "motis/json_writer.h"
+
+using namespace motis;
+
+TEST(motis, json_writer_escape) {
+  auto out = std::string{};
+  auto w = json_writer{out};
+  w.begin_object();
+  w.member("a", std::string_view{"x\"y\\z\n\x01"});
+  w.member("b", std::optional<int>{});
+  w.member("c", std::vector<double>{1.5, -2.0});
+  w.end_object();
+  EXPECT_EQ(R"({"a":"x\"y\\z\n\u0001","c":[1.5,-2.0]})", out);
+}
+
+TEST(motis, json_writer_api_type) {
+  auto const p =
+      api::EncodedPolyline{.points_ = "_p~iF", .length_ = 1, .precision_ = 5};
+  EXPECT_EQ(boost::json::value_from(p),
+            boost::json::parse(to_json_string(p)));
+}
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #include "utl/progress_tracker.h"
 
+#include "motis/footpath_shards.h"
+
 #include "test_dir.h"
 
 #ifdef PROTOBUF_LINKED
@@ -12,8 +14,14 @@
 #endif
 
 namespace fs = std::filesystem;
+using namespace std::string_view_literals;
 
 int main(int argc, char** argv) {
+  // Footpath shard workers started by import tests run this executable.
+  if (argc > 1 && argv[1] == "footpaths"sv) {
+    return motis::footpaths(argc - 1, argv + 1);
+  }
+
   std::clog.rdbuf(std::cout.rdbuf());
 
   auto const progress_tracker = utl::activate_progress_tracker("test");
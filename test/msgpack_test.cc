@@ -0,0 +1,26 @@
+#include "gtest/gtest.h"
+
+#include "motis-api/motis-api.h"
+#include "motis/msgpack.h"
+
+using namespace std::string_literals;
+using namespace motis;
+
+TEST(motis, msgpack_encoded_polyline) {
+  auto const p =
+      api::EncodedPolyline{.points_ = "abc", .length_ = 2, .precision_ = 7};
+  EXPECT_EQ("\x83\xA6points\xA3"
+            "abc\xA6length\x02\xA9precision\x07"s,
+            to_msgpack(p));
+}
+
+TEST(motis, msgpack_numbers) {
+  auto const encode = [](auto const x) { return to_msgpack(x); };
+  EXPECT_EQ("\xFF"s, encode(-1));
+  EXPECT_EQ("\xD0\xDF"s, encode(-33));
+  EXPECT_EQ("\xCC\x80"s, encode(128));
+  EXPECT_EQ("\xCD\x01\x00"s, encode(256));
+  EXPECT_EQ("\xCB\x3F\xF8\x00\x00\x00\x00\x00\x00"s, encode(1.5));
+  EXPECT_EQ("\x92\xC3\xC0"s,
+            encode(std::vector<std::optional<bool>>{true, std::nullopt}));
+}
\ No newline at end of file
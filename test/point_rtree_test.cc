@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+
+#include "cista/serialization.h"
+
+#include "motis/point_rtree.h"
+
+using namespace motis;
+
+namespace {
+
+std::vector<point_rtree<std::uint32_t>::entry> random_points() {
+  auto gen = std::mt19937{42U};
+  auto lat = std::uniform_real_distribution{49.9, 50.2};
+  auto lng = std::uniform_real_distribution{8.5, 8.9};
+  auto entries = std::vector<point_rtree<std::uint32_t>::entry>{};
+  for (auto i = 0U; i != 5000U; ++i) {
+    entries.push_back({{lat(gen), lng(gen)}, i});
+  }
+  return entries;
+}
+
+}  // namespace
+
+TEST(motis, point_rtree_in_radius) {
+  auto const entries = random_points();
+  auto const rtree = point_rtree<std::uint32_t>{entries};
+
+  for (auto const radius : {50.0, 2000.0, 15000.0}) {
+    auto const x = geo::latlng{50.05, 8.7};
+    auto expected = std::vector<std::uint32_t>{};
+    for (auto const& e : entries) {
+      if (geo::distance(x, e.pos_) < radius) {
+        expected.push_back(e.item_);
+      }
+    }
+
+    auto found = rtree.in_radius(x, radius);
+    std::sort(begin(found), end(found));
+    EXPECT_EQ(expected, found);
+  }
+}
+
+TEST(motis, point_rtree_nearest) {
+  auto const entries = random_points();
+  auto const rtree = point_rtree<std::uint32_t>{entries};
+  auto const x = geo::latlng{50.1, 8.6};
+
+  auto by_distance = entries;
+  std::sort(begin(by_distance), end(by_distance),
+            [&](auto const& a, auto const& b) {
+              return geo::distance(x, a.pos_) < geo::distance(x, b.pos_);
+            });
+
+  auto const k = rtree.k_nearest(x, 10U);
+  ASSERT_EQ(10U, k.size());
+  for (auto i = 0U; i != k.size(); ++i) {
+    EXPECT_EQ(by_distance[i].item_, k[i]);
+  }
+
+  EXPECT_EQ(by_distance.front().item_, rtree.nearest(x, 10000.0));
+  EXPECT_FALSE(rtree.nearest(geo::latlng{52.5, 13.4}, 1000.0).has_value());
+}
+
+TEST(motis, point_rtree_serialize) {
+  auto const rtree = point_rtree<std::uint32_t>{random_points()};
+  auto buf = cista::serialize(rtree);
+  auto const copy = cista::deserialize<point_rtree<std::uint32_t>>(buf);
+
+  auto const x = geo::latlng{50.0, 8.8};
+  EXPECT_EQ(rtree.in_radius(x, 3000.0), copy->in_radius(x, 3000.0));
+}
\ No newline at end of file
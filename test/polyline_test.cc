@@ -0,0 +1,39 @@
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "motis/polyline.h"
+#include "motis/request_arena.h"
+
+using namespace motis;
+
+TEST(motis, encode_polyline) {
+  auto const line = std::vector<geo::latlng>{
+      {38.5, -120.2}, {40.7, -120.95}, {43.252, -126.453}};
+  EXPECT_EQ("_p~iF~ps|U_ulLnnqC_mqNvxq`@", encode_polyline(line, 5U));
+}
+
+TEST(motis, simplify_polyline) {
+  // ~1km straight line north with a ~1m bump in the middle
+  auto const line = std::vector<geo::latlng>{{50.0, 8.0},
+                                             {50.0025, 8.0},
+                                             {50.0045, 8.000014},
+                                             {50.0065, 8.0},
+                                             {50.009, 8.0}};
+
+  auto const coarse = simplify(line, 5.0);
+  ASSERT_EQ(2U, coarse.size());
+  EXPECT_EQ(line.front(), coarse.front());
+  EXPECT_EQ(line.back(), coarse.back());
+
+  auto const fine = simplify(line, 0.5);
+  ASSERT_EQ(3U, fine.size());
+  EXPECT_EQ(line[2], fine[1]);
+
+  EXPECT_EQ(line, simplify(line, 0.0));
+
+  auto arena = request_arena{};
+  auto const pmr_fine = simplify(line, 0.5, arena.get());
+  EXPECT_TRUE(std::equal(begin(fine), end(fine), begin(pmr_fine),
+                         end(pmr_fine)));
+}
\ No newline at end of file
@@ -3,14 +3,17 @@
 #include "boost/json.hpp"
 
 #include "utl/init_from.h"
+#include "utl/zip.h"
 
 #include "motis/config.h"
 #include "motis/data.h"
 #include "motis/elevators/parse_fasta.h"
 #include "motis/endpoints/routing.h"
 #include "motis/import.h"
+#include "motis/json_writer.h"
 
 namespace json = boost::json;
+using namespace std::string_literals;
 using namespace std::string_view_literals;
 using namespace motis;
 using namespace date;
@@ -144,6 +147,7 @@ S3,DB,S3,,,109
 RB,DB,RB,,,106
 U4,DB,U4,,,402
 ICE,DB,ICE,,,101
+RE,DB,RE,,,106
 
 # trips.txt
 route_id,service_id,trip_id,trip_headsign,block_id
@@ -151,6 +155,7 @@ S3,S1,S3,,
 RB,S1,RB,,
 U4,S1,U4,,
 ICE,S1,ICE,,
+RE,S1,RE,,
 
 # stop_times.txt
 trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
@@ -163,6 +168,9 @@ U4,01:05:00,01:05:00,de:6412:10:6:1,0,0,0
 U4,01:10:00,01:10:00,FFM_HAUPT_U,1,0,0
 ICE,00:45:00,00:45:00,DA_10,0,0,0
 ICE,00:55:00,00:55:00,FFM_12,1,0,0
+RE,10:00:00,10:00:00,DA_3,0,0,0
+RE,10:10:00,10:10:00,LANGEN,1,0,0
+RE,10:20:00,10:20:00,FFM_101,2,0,0
 
 # calendar_dates.txt
 service_id,date,exception_type
@@ -241,6 +249,9 @@ TEST(motis, routing) {
         "/?fromPlace=49.87263,8.63127&toPlace=50.11347,8.67664"
         "&date=05-01-2019&time=01:25&wheelchair=true");
 
+    EXPECT_EQ(json::value_from(plan_response),
+              json::parse(to_json_string(plan_response)));
+
     auto ss = std::stringstream{};
     for (auto const& j : plan_response.itineraries_) {
       print_short(ss, j);
@@ -263,6 +274,9 @@ TEST(motis, routing) {
         "/?fromPlace=49.87263,8.63127&toPlace=50.11347,8.67664"
         "&date=05-01-2019&time=01:25");
 
+    EXPECT_EQ(json::value_from(plan_response),
+              json::parse(to_json_string(plan_response)));
+
     auto ss = std::stringstream{};
     for (auto const& j : plan_response.itineraries_) {
       print_short(ss, j);
@@ -278,4 +292,50 @@ TEST(motis, routing) {
 ])",
         ss.str());
   }
+
+  // Intermediate stops as references into the place table.
+  {
+    auto const url =
+        "/?fromPlace=test_DA_3&toPlace=test_FFM_101"
+        "&date=05-01-2019&time=07:30"s;
+    auto const full = routing(url);
+    auto const compact = routing(url + "&compactPlaces=true");
+
+    EXPECT_EQ(json::value_from(compact),
+              json::parse(to_json_string(compact)));
+    EXPECT_FALSE(full.places_.has_value());
+    ASSERT_TRUE(compact.places_.has_value());
+
+    auto n_stops = 0U;
+    ASSERT_EQ(full.itineraries_.size(), compact.itineraries_.size());
+    for (auto const [a, b] :
+         utl::zip(full.itineraries_, compact.itineraries_)) {
+      ASSERT_EQ(a.legs_.size(), b.legs_.size());
+      for (auto const [la, lb] : utl::zip(a.legs_, b.legs_)) {
+        EXPECT_EQ(json::value_from(la.from_), json::value_from(lb.from_));
+        EXPECT_EQ(json::value_from(la.to_), json::value_from(lb.to_));
+        EXPECT_FALSE(lb.intermediateStops_.has_value());
+        ASSERT_EQ(la.intermediateStops_.has_value(),
+                  lb.intermediateStopRefs_.has_value());
+        if (!la.intermediateStops_.has_value()) {
+          continue;
+        }
+
+        ASSERT_EQ(la.intermediateStops_->size(),
+                  lb.intermediateStopRefs_->size());
+        for (auto const [stop, ref] :
+             utl::zip(*la.intermediateStops_, *lb.intermediateStopRefs_)) {
+          auto const& p =
+              compact.places_->at(static_cast<std::size_t>(ref.placeIdx_));
+          EXPECT_EQ(stop.name_, p.name_);
+          EXPECT_EQ(stop.stopId_, p.stopId_);
+          EXPECT_EQ(stop.track_, p.track_);
+          EXPECT_EQ(stop.arrival_, ref.arrival_);
+          EXPECT_EQ(stop.departure_, ref.departure_);
+          ++n_stops;
+        }
+      }
+    }
+    EXPECT_EQ(1U, n_stops);
+  }
 }
\ No newline at end of file
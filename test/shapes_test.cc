@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+
+#include "geo/latlng.h"
+
+#include "nigiri/timetable.h"
+
+#include "motis/config.h"
+#include "motis/data.h"
+#include "motis/import.h"
+#include "motis/shapes.h"
+#include "motis/tag_lookup.h"
+#include "motis/trip_id_index.h"
+
+namespace n = nigiri;
+using namespace std::string_view_literals;
+using namespace motis;
+
+// The shape leaves the straight line between A and B by ~1 m.
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon,location_type,parent_station,platform_code
+A,A,50.0,8.0,0,,
+B,B,50.0,8.01,0,,
+C,C,50.0,8.02,0,,
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+RE,DB,RE,,,106
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id,shape_id
+RE,S1,RE,,,SHP
+
+# shapes.txt
+shape_id,shape_pt_lat,shape_pt_lon,shape_pt_sequence
+SHP,50.0,8.0,0
+SHP,50.00001,8.0025,1
+SHP,50.0,8.005,2
+SHP,50.0,8.0075,3
+SHP,50.0,8.01,4
+SHP,50.0,8.0125,5
+SHP,50.0,8.015,6
+SHP,50.0,8.0175,7
+SHP,50.0,8.02,8
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+RE,10:00:00,10:00:00,A,0,0,0
+RE,10:10:00,10:10:00,B,1,0,0
+RE,10:20:00,10:20:00,C,2,0,0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+)"sv;
+
+TEST(motis, shapes_get_level) {
+  EXPECT_EQ(0U, shapes::get_level(0.0));
+  EXPECT_EQ(0U, shapes::get_level(1.9));
+  EXPECT_EQ(1U, shapes::get_level(2.0));
+  EXPECT_EQ(2U, shapes::get_level(49.0));
+  EXPECT_EQ(3U, shapes::get_level(50.0));
+  EXPECT_EQ(3U, shapes::get_level(1000.0));
+}
+
+TEST(motis, shapes_get) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all("test/data_shapes", ec);
+
+  auto const d = import(
+      config{.timetable_ =
+                 config::timetable{
+                     .first_day_ = "2019-05-01",
+                     .num_days_ = 2,
+                     .with_shapes_ = true,
+                     .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}}},
+      "test/data_shapes", false);
+  ASSERT_NE(nullptr, d.shapes_);
+
+  auto const& tt = *d.tt_;
+  auto const trips = d.trip_ids_->find(tt, d.tags_->get_src("test"), "RE");
+  ASSERT_EQ(1U, trips.size());
+  auto const trip = trips.front().second;
+  auto const t = tt.trip_transport_ranges_[trip][0].first;
+
+  auto const near = [](geo::latlng const& a, geo::latlng const& b) {
+    return geo::distance(a, b) < 0.5;
+  };
+  auto const a = geo::latlng{50.0, 8.0};
+  auto const b = geo::latlng{50.0, 8.01};
+  auto const c = geo::latlng{50.0, 8.02};
+
+  // Stops are sliced at the shape points they were matched to.
+  auto const ab = d.shapes_->get(tt, trip, t, {0U, 2U}, 0U);
+  ASSERT_EQ(5U, ab.size());
+  EXPECT_TRUE(near(a, ab.front()));
+  EXPECT_TRUE(near(b, ab.back()));
+
+  auto const bc = d.shapes_->get(tt, trip, t, {1U, 3U}, 0U);
+  ASSERT_EQ(5U, bc.size());
+  EXPECT_TRUE(near(b, bc.front()));
+  EXPECT_TRUE(near(c, bc.back()));
+
+  EXPECT_EQ(9U, d.shapes_->get(tt, trip, t, {0U, 3U}, 0U).size());
+
+  // Coarser levels drop the detour but keep the stops.
+  auto const coarse = d.shapes_->get(tt, trip, t, {0U, 3U}, 3U);
+  ASSERT_EQ(3U, coarse.size());
+  EXPECT_TRUE(near(a, coarse[0]));
+  EXPECT_TRUE(near(b, coarse[1]));
+  EXPECT_TRUE(near(c, coarse[2]));
+  EXPECT_EQ(2U, d.shapes_->get(tt, trip, t, {0U, 2U}, 1U).size());
+
+  // A leg needs at least two stops.
+  EXPECT_TRUE(d.shapes_->get(tt, trip, t, {0U, 1U}, 0U).empty());
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+
+#include "boost/json.hpp"
+#include "boost/url/url_view.hpp"
+
+#include "utl/init_from.h"
+
+#include "motis/config.h"
+#include "motis/data.h"
+#include "motis/endpoints/stop_times.h"
+#include "motis/import.h"
+#include "motis/json_writer.h"
+
+namespace json = boost::json;
+using namespace std::string_view_literals;
+using namespace motis;
+
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon,location_type,parent_station,platform_code
+DA,DA Hbf,49.87260,8.63085,1,,
+DA_10,DA Hbf,49.87336,8.62926,0,DA,10
+LANGEN,Langen,49.99359,8.65677,1,,1
+FFM,FFM Hbf,50.10701,8.66341,1,,
+FFM_12,FFM Hbf,50.10658,8.66178,0,FFM,12
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type,route_color,route_text_color
+RB,DB,RB,,,106,,
+ICE,DB,ICE,,,101,FF0000,FFFFFF
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id
+RB,S1,RB,Frankfurt,
+ICE,S1,ICE,,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+RB,00:35:00,00:35:00,DA_10,0,0,0
+RB,00:45:00,00:45:00,LANGEN,1,0,0
+RB,00:55:00,00:55:00,FFM_12,2,0,0
+ICE,00:45:00,00:45:00,DA_10,0,0,0
+ICE,00:55:00,00:55:00,FFM_12,1,0,0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+
+# frequencies.txt
+trip_id,start_time,end_time,headway_secs
+RB,00:35:00,24:35:00,3600
+ICE,00:45:00,24:45:00,3600
+)"sv;
+
+TEST(motis, stop_times_json) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all("test/data_stop_times", ec);
+
+  auto d = import(
+      config{.timetable_ =
+                 config::timetable{
+                     .first_day_ = "2019-05-01",
+                     .num_days_ = 2,
+                     .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}}},
+      "test/data_stop_times", false);
+  auto const stop_times = utl::init_from<ep::stop_times>(d).value();
+
+  for (auto const url : {
+           "/?stopId=test_DA_10&time=2019-04-30T23:00:00Z&n=5"sv,
+           "/?stopId=test_FFM_12&time=2019-05-01T02:00:00Z&n=3&arriveBy=true"sv,
+           "/?stopId=test_LANGEN&time=2019-05-01T02:00:00Z&n=2&debug=true"sv,
+       }) {
+    auto const res = stop_times(boost::urls::url_view{url});
+    EXPECT_FALSE(res.stopTimes_.empty()) << url;
+    EXPECT_EQ(json::value_from(res), json::parse(to_json_string(res))) << url;
+  }
+}
\ No newline at end of file
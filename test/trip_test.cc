@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+
+#include "boost/json.hpp"
+#include "boost/url/url_view.hpp"
+
+#include "utl/init_from.h"
+
+#include "nigiri/timetable.h"
+
+#include "motis/config.h"
+#include "motis/data.h"
+#include "motis/endpoints/trip.h"
+#include "motis/import.h"
+#include "motis/json_writer.h"
+#include "motis/tag_lookup.h"
+#include "motis/trip_id_index.h"
+
+namespace n = nigiri;
+namespace json = boost::json;
+using namespace std::string_view_literals;
+using namespace motis;
+
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon,location_type,parent_station,platform_code
+DA_10,DA Hbf,49.87336,8.62926,0,,10
+FFM_12,FFM Hbf,50.10658,8.66178,0,,12
+FFM_101,FFM Hbf,50.10739,8.66333,0,,101
+FFM_HAUPT_S,FFM Hauptwache S,50.11404,8.67824,0,,
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+ICE,DB,ICE,,,101
+S3,DB,S3,,,109
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id
+ICE,S1,ICE,,
+S3,S1,S3,,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+ICE,10:00:00,10:00:00,DA_10,0,0,0
+ICE,10:15:00,10:15:00,FFM_12,1,0,0
+S3,10:30:00,10:30:00,FFM_101,0,0,0
+S3,10:35:00,10:35:00,FFM_HAUPT_S,1,0,0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+)"sv;
+
+TEST(motis, trip_id_index) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all("test/data_trip_id_index", ec);
+
+  // Both datasets contain the same trip ids.
+  auto const d = import(
+      config{.timetable_ =
+                 config::timetable{
+                     .first_day_ = "2019-05-01",
+                     .num_days_ = 2,
+                     .datasets_ = {{"a", {.path_ = std::string{kGTFS}}},
+                                   {"b", {.path_ = std::string{kGTFS}}}}}},
+      "test/data_trip_id_index", false);
+  auto const& tt = *d.tt_;
+  auto const index = trip_id_index{tt};
+
+  for (auto const tag : {"a"sv, "b"sv}) {
+    auto const src = d.tags_->get_src(tag);
+    auto const ice = index.find(tt, src, "ICE");
+    ASSERT_EQ(1U, ice.size()) << tag;
+    EXPECT_EQ(src, tt.trip_id_src_[ice.front().first]);
+    EXPECT_EQ("ICE", tt.trip_id_strings_[ice.front().first].view());
+
+    auto const s3 = index.find(tt, src, "S3");
+    ASSERT_EQ(1U, s3.size()) << tag;
+    EXPECT_NE(ice.front().second, s3.front().second);
+
+    EXPECT_TRUE(index.find(tt, src, "RB").empty());
+  }
+
+  EXPECT_NE(index.find(tt, d.tags_->get_src("a"), "ICE").front().second,
+            index.find(tt, d.tags_->get_src("b"), "ICE").front().second);
+}
+
+TEST(motis, trips) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all("test/data_trips", ec);
+
+  auto d = import(
+      config{.osm_ = {"test/resources/test_case.osm.pbf"},
+             .timetable_ =
+                 config::timetable{
+                     .first_day_ = "2019-05-01",
+                     .num_days_ = 2,
+                     .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}},
+             .street_routing_ = true},
+      "test/data_trips", false);
+  auto const trips = utl::init_from<ep::trips>(d).value();
+
+  auto const response = trips(boost::urls::url_view{
+      "/?tripId=test_ICE,test_S3,test_ICE"
+      "&date=2019-05-01,2019-05-01,2019-05-01"});
+  ASSERT_EQ(3U, response.size());
+  for (auto const& [i, from, to] :
+       {std::tuple{0U, "test_DA_10"sv, "test_FFM_12"sv},
+        std::tuple{1U, "test_FFM_101"sv, "test_FFM_HAUPT_S"sv},
+        std::tuple{2U, "test_DA_10"sv, "test_FFM_12"sv}}) {
+    ASSERT_EQ(1U, response[i].legs_.size());
+    auto const& leg = response[i].legs_.front();
+    EXPECT_EQ(from, leg.from_.stopId_.value_or("-"));
+    EXPECT_EQ(to, leg.to_.stopId_.value_or("-"));
+  }
+  EXPECT_EQ(response[0].startTime_, response[2].startTime_);
+
+  auto const trip = utl::init_from<ep::trip>(d).value();
+  auto const itinerary = trip(
+      boost::urls::url_view{"/?tripId=test_S3&date=2019-05-01&debug=true"});
+  EXPECT_EQ(json::value_from(itinerary),
+            json::parse(to_json_string(itinerary)));
+
+  // Lists of different length.
+  EXPECT_ANY_THROW(trips(boost::urls::url_view{
+      "/?tripId=test_ICE,test_S3&date=2019-05-01"}));
+
+  // Unknown trip.
+  EXPECT_ANY_THROW(trips(
+      boost::urls::url_view{"/?tripId=test_RB&date=2019-05-01"}));
+
+  // More than 100 trips.
+  auto too_many = std::string{"/?tripId=test_ICE"};
+  auto dates = std::string{"&date=2019-05-01"};
+  for (auto i = 0U; i != 100U; ++i) {
+    too_many += ",test_ICE";
+    dates += ",2019-05-01";
+  }
+  EXPECT_ANY_THROW(trips(boost::urls::url_view{too_many + dates}));
+}
\ No newline at end of file
@@ -141,7 +141,7 @@ export const ModeSchema = {
 export const StopTimeSchema = {
     description: 'departure or arrival event at a stop',
     type: 'object',
-    required: ['mode', 'time', 'delay', 'realTime', 'route', 'headsign', 'agencyId', 'agencyName', 'agencyUrl', 'routeColor', 'routeTextColor', 'routeType', 'routeId', 'tripId', 'serviceDate', 'routeShortName', 'source'],
+    required: ['mode', 'time', 'delay', 'realTime', 'route', 'headsign', 'agencyId', 'agencyName', 'agencyUrl', 'routeColor', 'routeTextColor', 'routeType', 'routeId', 'tripId', 'serviceDate', 'routeShortName'],
     properties: {
         mode: {
             '$ref': '#/components/schemas/Mode',
@@ -206,7 +206,12 @@ For non-transit legs, null
             type: 'string'
         },
         source: {
-            description: 'Filename and line number where this trip is from',
+            description: `Filename and line number where this trip is from.
+Only set if \`debug=true\`.
+
+Breaking change: \`source\` used to be always set. Clients that
+read it have to pass \`debug=true\` now.
+`,
             type: 'string'
         }
     }
@@ -276,6 +281,33 @@ Scheduled time of departure at boarding stop = startTime - departureDelay
     }
 } as const;
 
+export const PlaceRefSchema = {
+    type: 'object',
+    required: ['placeIdx'],
+    properties: {
+        placeIdx: {
+            description: 'index into the `places` of the response',
+            type: 'integer'
+        },
+        arrivalDelay: {
+            type: 'integer',
+            description: 'offset from the scheduled arrival time'
+        },
+        departureDelay: {
+            type: 'integer',
+            description: 'offset from the scheduled departure time'
+        },
+        arrival: {
+            description: 'arrival time, format = unixtime in milliseconds',
+            type: 'integer'
+        },
+        departure: {
+            description: 'departure time, format = unixtime in milliseconds',
+            type: 'integer'
+        }
+    }
+} as const;
+
 export const RelativeDirectionSchema = {
     type: 'string',
     enum: ['DEPART', 'HARD_LEFT', 'LEFT', 'SLIGHTLY_LEFT', 'CONTINUE', 'SLIGHTLY_RIGHT', 'RIGHT', 'HARD_RIGHT', 'CIRCLE_CLOCKWISE', 'CIRCLE_COUNTERCLOCKWISE', 'ELEVATOR', 'UTURN_LEFT', 'UTURN_RIGHT']
@@ -332,7 +364,7 @@ and thus the directions should say something like "cross"
 
 export const EncodedPolylineSchema = {
     type: 'object',
-    required: ['points', 'length'],
+    required: ['points', 'length', 'precision'],
     properties: {
         points: {
             description: 'The encoded points of the polyline.',
@@ -341,28 +373,37 @@ export const EncodedPolylineSchema = {
         length: {
             description: 'The number of points in the string',
             type: 'integer'
+        },
+        precision: {
+            description: 'The number of decimal places used to encode the points',
+            type: 'integer'
         }
     }
 } as const;
 
-export const LevelEncodedPolylineSchema = {
+export const LevelRangeSchema = {
     type: 'object',
-    required: ['from_level', 'to_level', 'polyline'],
+    required: ['from_level', 'to_level', 'from_index', 'to_index'],
     properties: {
         from_level: {
             description: 'level where this segment starts, based on OpenStreetMap data',
             type: 'number'
         },
         to_level: {
-            description: 'level where this segment starts, based on OpenStreetMap data',
+            description: 'level where this segment ends, based on OpenStreetMap data',
             type: 'number'
         },
         osm_way: {
             description: 'OpenStreetMap way index',
             type: 'integer'
         },
-        polyline: {
-            '$ref': '#/components/schemas/EncodedPolyline'
+        from_index: {
+            description: 'index of the first point of this segment in `legGeometry`',
+            type: 'integer'
+        },
+        to_index: {
+            description: 'index of the last point of this segment in `legGeometry` (inclusive)',
+            type: 'integer'
         }
     }
 } as const;
@@ -460,7 +501,12 @@ For non-transit legs, null
             type: 'string'
         },
         source: {
-            description: 'Filename and line number where this trip is from',
+            description: `Filename and line number where this trip is from.
+Only set if \`debug=true\`.
+
+Breaking change: \`source\` used to be always set. Clients that
+read it have to pass \`debug=true\` now.
+`,
             type: 'string'
         },
         intermediateStops: {
@@ -472,14 +518,24 @@ and the Place where the leg ends. For non-transit legs, null.
                 '$ref': '#/components/schemas/Place'
             }
         },
+        intermediateStopRefs: {
+            description: `Only set for \`compactPlaces=true\`: replaces \`intermediateStops\`.
+`,
+            type: 'array',
+            items: {
+                '$ref': '#/components/schemas/PlaceRef'
+            }
+        },
         legGeometry: {
             '$ref': '#/components/schemas/EncodedPolyline'
         },
-        legGeometryWithLevels: {
-            description: 'Like `legGeometry`, but split at level changes',
+        legGeometryLevels: {
+            description: `For street legs, the segments of \`legGeometry\` with their levels.
+Replaces \`legGeometryWithLevels\` which repeated the geometry.
+`,
             type: 'array',
             items: {
-                '$ref': '#/components/schemas/LevelEncodedPolyline'
+                '$ref': '#/components/schemas/LevelRange'
             }
         },
         steps: {
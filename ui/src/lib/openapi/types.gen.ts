@@ -176,9 +176,14 @@ export type StopTime = {
     serviceDate: string;
     routeShortName: string;
     /**
-     * Filename and line number where this trip is from
+     * Filename and line number where this trip is from.
+     * Only set if `debug=true`.
+     *
+     * Breaking change: `source` used to be always set. Clients that
+     * read it have to pass `debug=true` now.
+     *
      */
-    source: string;
+    source?: string;
 };
 
 /**
@@ -238,6 +243,29 @@ export type Place = {
     vertexType?: VertexType;
 };
 
+export type PlaceRef = {
+    /**
+     * index into the `places` of the response
+     */
+    placeIdx: number;
+    /**
+     * offset from the scheduled arrival time
+     */
+    arrivalDelay?: number;
+    /**
+     * offset from the scheduled departure time
+     */
+    departureDelay?: number;
+    /**
+     * arrival time, format = unixtime in milliseconds
+     */
+    arrival?: number;
+    /**
+     * departure time, format = unixtime in milliseconds
+     */
+    departure?: number;
+};
+
 export type RelativeDirection = 'DEPART' | 'HARD_LEFT' | 'LEFT' | 'SLIGHTLY_LEFT' | 'CONTINUE' | 'SLIGHTLY_RIGHT' | 'RIGHT' | 'HARD_RIGHT' | 'CIRCLE_CLOCKWISE' | 'CIRCLE_COUNTERCLOCKWISE' | 'ELEVATOR' | 'UTURN_LEFT' | 'UTURN_RIGHT';
 
 export type AbsoluteDirection = 'NORTH' | 'NORTHEAST' | 'EAST' | 'SOUTHEAST' | 'SOUTH' | 'SOUTHWEST' | 'WEST' | 'NORTHWEST';
@@ -287,22 +315,33 @@ export type EncodedPolyline = {
      * The number of points in the string
      */
     length: number;
+    /**
+     * The number of decimal places used to encode the points
+     */
+    precision: number;
 };
 
-export type LevelEncodedPolyline = {
+export type LevelRange = {
     /**
      * level where this segment starts, based on OpenStreetMap data
      */
     from_level: number;
     /**
-     * level where this segment starts, based on OpenStreetMap data
+     * level where this segment ends, based on OpenStreetMap data
      */
     to_level: number;
     /**
      * OpenStreetMap way index
      */
     osm_way?: number;
-    polyline: EncodedPolyline;
+    /**
+     * index of the first point of this segment in `legGeometry`
+     */
+    from_index: number;
+    /**
+     * index of the last point of this segment in `legGeometry` (inclusive)
+     */
+    to_index: number;
 };
 
 export type Leg = {
@@ -371,7 +410,12 @@ export type Leg = {
     serviceDate?: string;
     routeShortName?: string;
     /**
-     * Filename and line number where this trip is from
+     * Filename and line number where this trip is from.
+     * Only set if `debug=true`.
+     *
+     * Breaking change: `source` used to be always set. Clients that
+     * read it have to pass `debug=true` now.
+     *
      */
     source?: string;
     /**
@@ -380,11 +424,18 @@ export type Leg = {
      *
      */
     intermediateStops?: Array<Place>;
+    /**
+     * Only set for `compactPlaces=true`: replaces `intermediateStops`.
+     *
+     */
+    intermediateStopRefs?: Array<PlaceRef>;
     legGeometry: EncodedPolyline;
     /**
-     * Like `legGeometry`, but split at level changes
+     * For street legs, the segments of `legGeometry` with their levels.
+     * Replaces `legGeometryWithLevels` which repeated the geometry.
+     *
      */
-    legGeometryWithLevels?: Array<LevelEncodedPolyline>;
+    legGeometryLevels?: Array<LevelRange>;
     /**
      * A series of turn by turn instructions
      * used for walking, biking and driving.
@@ -596,6 +647,15 @@ export type PlanData = {
          *
          */
         arriveBy?: boolean;
+        /**
+         * Optional. Default is `false`.
+         *
+         * If set, transit legs list their intermediate stops as
+         * `intermediateStopRefs` instead of `intermediateStops`.
+         * Every referenced stop is written once to `places`.
+         *
+         */
+        compactPlaces?: boolean;
         /**
          * Optional. Defaults to the current date.
          *
@@ -762,6 +822,11 @@ export type PlanResponse = ({
      *
      */
     nextPageCursor: string;
+    /**
+     * Only set for `compactPlaces=true`: all stops referenced by `intermediateStopRefs`.
+     *
+     */
+    places?: Array<Place>;
 });
 
 export type PlanError = unknown;